@@ -38,6 +38,38 @@
  * Double b = a * Double(3.14);
  * b *= Double(2);
  *
+ * Double("...") converts the text at runtime with fp64_atof. Constants
+ * given as "..."_fp64 or FP64_CONST("...") are converted by the compiler,
+ * e.g. const Double c = "1.234567890123456"_fp64;
+ *
+ * With "#include <fp64inline.h>" before "#include <Double.h>", the comparison
+ * operators and the unary minus use the inline versions of fp64_compare and
+ * fp64_neg instead of calls into the library.
+ *
+ * The operators +, -, * and / do not compute their result immediately, they
+ * return a small expression object that is evaluated when it is assigned
+ * to a Double or passed to a function expecting a Double. This allows to
+ * map combinations of operations to a single call into fp64lib, e.g.
+ *   a*b + c, c + a*b, a*b - c, c - a*b and r += a*b
+ * are computed by fp64_fma, with the product kept unpacked and exact and
+ * only one rounding at the end. a*b + c*d uses one fp64_mul and one fp64_fma.
+ * This fusion is the only one: all other operations are computed one by one
+ * with the packed fp64_* functions, exactly as before, and intermediate
+ * results are not kept in the unpacked form between operations. Loading
+ * and storing the unpacked form costs about 200 cycles each, more than a
+ * chain of packed calls saves.
+ *
+ * Measured on an ATmega328P (simulated, cycles of the fp64lib calls):
+ *   a*b + c    fp64_mul + fp64_add 904 cycles, fp64_fma 775 cycles
+ *   a*b + c*d  1421 cycles before, 1292 cycles with fp64_fma
+ *   Horner's scheme of degree 10 (examples/Double), 9287 -> 7692 cycles
+ *   a*b - 1 (examples/double_vs_float), 818 -> 946 cycles, but exact
+ * fp64_fma needs 1432 bytes of flash in addition to fp64_mul and fp64_add,
+ * once per sketch. So the fusion pays off in speed and accuracy, but not in
+ * flash if a sketch uses fp64_fma nowhere else.
+ * Expression objects refer to the Double variables used in them, so they
+ * should not be stored (e.g. with "auto e = a*b;"), but assigned to a Double.
+ *
  * For more see online documentation at https://fp64lib.org or in the provided
  * demo programs for fp64lib.
  */
@@ -46,120 +78,244 @@
 #define DOUBLE_H
 #include <fp64lib.h>
 
-class Double {
+class Double;
+
+// base of all expressions, E is the derived expression type
+template<class E> struct DoubleExpr {
+	const E& self() const { return *static_cast<const E*>(this); }
+};
+
+// Double variables are referenced in an expression, expressions are copied
+template<class E> struct DoubleRef { typedef E type; };
+template<> struct DoubleRef<Double> { typedef const Double& type; };
+
+template<class L, class R> struct DoubleAdd;
+template<class L, class R> struct DoubleSub;
+template<class L, class R> struct DoubleMul;
+template<class L, class R> struct DoubleDiv;
+
+// evaluation of l+r and l-r, specialized below to use fp64_fma
+template<class L, class R> struct DoubleAddEval {
+	static float64_t eval( const L& l, const R& r ) {
+		return fp64_add( l.eval(), r.eval() );
+	}
+};
+template<class L, class R> struct DoubleSubEval {
+	static float64_t eval( const L& l, const R& r ) {
+		return fp64_sub( l.eval(), r.eval() );
+	}
+};
+
+template<class L, class R> struct DoubleAdd : DoubleExpr< DoubleAdd<L,R> > {
+	typename DoubleRef<L>::type l;
+	typename DoubleRef<R>::type r;
+	DoubleAdd( const L& a, const R& b ) : l(a), r(b) {}
+	float64_t eval() const { return DoubleAddEval<L,R>::eval( l, r ); }
+};
+template<class L, class R> struct DoubleSub : DoubleExpr< DoubleSub<L,R> > {
+	typename DoubleRef<L>::type l;
+	typename DoubleRef<R>::type r;
+	DoubleSub( const L& a, const R& b ) : l(a), r(b) {}
+	float64_t eval() const { return DoubleSubEval<L,R>::eval( l, r ); }
+};
+template<class L, class R> struct DoubleMul : DoubleExpr< DoubleMul<L,R> > {
+	typename DoubleRef<L>::type l;
+	typename DoubleRef<R>::type r;
+	DoubleMul( const L& a, const R& b ) : l(a), r(b) {}
+	float64_t eval() const { return fp64_mul( l.eval(), r.eval() ); }
+};
+template<class L, class R> struct DoubleDiv : DoubleExpr< DoubleDiv<L,R> > {
+	typename DoubleRef<L>::type l;
+	typename DoubleRef<R>::type r;
+	DoubleDiv( const L& a, const R& b ) : l(a), r(b) {}
+	float64_t eval() const { return fp64_div( l.eval(), r.eval() ); }
+};
+template<class E> struct DoubleNeg : DoubleExpr< DoubleNeg<E> > {
+	typename DoubleRef<E>::type e;
+	DoubleNeg( const E& a ) : e(a) {}
+	float64_t eval() const { return fp64_neg( e.eval() ); }
+};
+
+// a*b + c and c + a*b --> fma(a,b,c)
+template<class A, class B, class R> struct DoubleAddEval< DoubleMul<A,B>, R > {
+	static float64_t eval( const DoubleMul<A,B>& l, const R& r ) {
+		return fp64_fma( l.l.eval(), l.r.eval(), r.eval() );
+	}
+};
+template<class L, class A, class B> struct DoubleAddEval< L, DoubleMul<A,B> > {
+	static float64_t eval( const L& l, const DoubleMul<A,B>& r ) {
+		return fp64_fma( r.l.eval(), r.r.eval(), l.eval() );
+	}
+};
+template<class A, class B, class C, class D> struct DoubleAddEval< DoubleMul<A,B>, DoubleMul<C,D> > {
+	static float64_t eval( const DoubleMul<A,B>& l, const DoubleMul<C,D>& r ) {
+		return fp64_fma( l.l.eval(), l.r.eval(), r.eval() );
+	}
+};
+// a*b - c --> fma(a,b,-c), c - a*b --> fma(-a,b,c)
+template<class A, class B, class R> struct DoubleSubEval< DoubleMul<A,B>, R > {
+	static float64_t eval( const DoubleMul<A,B>& l, const R& r ) {
+		return fp64_fma( l.l.eval(), l.r.eval(), fp64_neg( r.eval() ) );
+	}
+};
+template<class L, class A, class B> struct DoubleSubEval< L, DoubleMul<A,B> > {
+	static float64_t eval( const L& l, const DoubleMul<A,B>& r ) {
+		return fp64_fma( fp64_neg( r.l.eval() ), r.r.eval(), l.eval() );
+	}
+};
+template<class A, class B, class C, class D> struct DoubleSubEval< DoubleMul<A,B>, DoubleMul<C,D> > {
+	static float64_t eval( const DoubleMul<A,B>& l, const DoubleMul<C,D>& r ) {
+		return fp64_fma( l.l.eval(), l.r.eval(), fp64_neg( r.eval() ) );
+	}
+};
+
+class Double : public DoubleExpr<Double> {
 	public:
 		Double()				{ x = 0ULL; }
 		Double( double f )		{ x = fp64_sd( f ); }
 		Double( float f )		{ x = fp64_sd( f ); }
-		Double( float64_t f ) 	{ x = f; }
+		constexpr Double( float64_t f ) : x( f ) {}
 		Double( int16_t n )		{ x = fp64_int16_to_float64( n ); }
 		Double( uint16_t n )	{ x = fp64_uint16_to_float64( n ); }
 		Double( int32_t n )		{ x = fp64_int32_to_float64( n ); }
-		Double( char *s )		{ x = fp64_atof( s ); }
+		Double( const char *s )	{ x = fp64_atof( (char *) s ); }
 		Double( const Double& d ) { x = d.x; }
-		
-		const char* toString() { 
+		template<class E> Double( const DoubleExpr<E>& e ) { x = e.self().eval(); }
+
+		Double& operator=( const Double& y ) {
+			this->x = y.x;
+			return *this;
+			}
+		template<class E> Double& operator=( const DoubleExpr<E>& e ) {
+			this->x = e.self().eval();
+			return *this;
+			}
+
+		const char* toString() const { 
 			return fp64_to_string( x, 17, 15);
 			}
-		const char* toString( int prec ) {
+		const char* toString( int prec ) const {
 			return fp64_to_string( x, prec+2, prec);
 			}
-		float64_t data() {
+		float64_t data() const {
 			return this->x;
 		}
-			
-		Double operator+=( const Double& y ) {
+		// value of the leaf of an expression
+		float64_t eval() const {
+			return this->x;
+		}
+
+		Double& operator+=( const Double& y ) {
 			this->x = fp64_add( this->x, y.x );
 			return *this ;
 			}
-		Double operator+( const Double& y ) {
-			Double res;
-			res.x = fp64_add( this->x, y.x );
-			return res;
+		template<class E> Double& operator+=( const DoubleExpr<E>& e ) {
+			this->x = DoubleAdd<Double,E>( *this, e.self() ).eval();
+			return *this ;
 			}
-		Double operator-=( const Double& y ) {
+		Double& operator-=( const Double& y ) {
 			this->x = fp64_sub( this->x, y.x );
 			return *this;
 			}
-		Double operator-( const Double& y ) {
-			Double res;
-			res.x = fp64_sub( this->x, y.x );
-			return res;
-			}
-		Double operator-() {
-			Double res;
-			res.x = fp64_sub( float64_NUMBER_PLUS_ZERO, this->x );
-			return res;
+		template<class E> Double& operator-=( const DoubleExpr<E>& e ) {
+			this->x = DoubleSub<Double,E>( *this, e.self() ).eval();
+			return *this ;
 			}
-		Double operator*=( const Double& y ) {
+		Double& operator*=( const Double& y ) {
 			this->x = fp64_mul( this->x, y.x );
 			return *this;
 			}
-		Double operator*( const Double& y ) {
-			Double res;
-			res.x = fp64_mul( this->x, y.x );
-			return res;
-			}
-		Double operator/=( const Double& y ) {
+		Double& operator/=( const Double& y ) {
 			this->x = fp64_div( this->x, y.x );
 			return *this;
 			}
-		Double operator/( const Double& y ) {
-			Double res;
-			res.x = fp64_div( this->x, y.x );
-			return res;
-			}
-		Double operator%=( const Double& y ) {
+		Double& operator%=( const Double& y ) {
 			this->x = fp64_fmod( this->x, y.x );
 			return *this;
 			}
-		Double operator%( const Double &y ) {
-			Double res;
-			res.x = fp64_fmod( this->x, y.x );
-			return res;
+		friend Double operator%( const Double& x, const Double &y ) {
+			return Double( fp64_fmod( x.x, y.x ) );
 			}
-		bool operator<( const Double &y ) {
-			return fp64_compare( this->x, y.x ) < 0;
+		friend bool operator<( const Double& x, const Double &y ) {
+			return fp64_compare( x.x, y.x ) < 0;
 		}
-		bool operator>( const Double &y ) {
-			return fp64_compare( this->x, y.x ) > 0;
+		friend bool operator>( const Double& x, const Double &y ) {
+			return fp64_compare( x.x, y.x ) > 0;
 		}
-		bool operator<=( const Double &y ) {
-			return fp64_compare( this->x, y.x ) <= 0;
+		friend bool operator<=( const Double& x, const Double &y ) {
+			return fp64_compare( x.x, y.x ) <= 0;
 		}
-		bool operator>=( const Double &y ) {
-			return fp64_compare( this->x, y.x ) >= 0;
+		friend bool operator>=( const Double& x, const Double &y ) {
+			return fp64_compare( x.x, y.x ) >= 0;
 		}
-		bool operator==( const Double &y ) {
-			return fp64_compare( this->x, y.x ) == 0;
+		friend bool operator==( const Double& x, const Double &y ) {
+			return fp64_compare( x.x, y.x ) == 0;
 		}
-		bool operator!=( const Double &y ) {
-			return fp64_compare( this->x, y.x ) != 0;
+		friend bool operator!=( const Double& x, const Double &y ) {
+			return fp64_compare( x.x, y.x ) != 0;
 		}
 		static Double pow( const Double &x, const Double &y ) {
-			Double res;
-			res.x = fp64_pow( x.x, y.x );
-			return res;
+			return Double( fp64_pow( x.x, y.x ) );
+		}
+		static Double powi( const Double &x, int n ) {
+			return Double( fp64_powi( x.x, n ) );
 		}
 		static Double sqrt( const Double &x ) {
-			Double res;
-			res.x = fp64_sqrt( x.x );
-			return res;
+			return Double( fp64_sqrt( x.x ) );
+		}
+		static Double rsqrt( const Double &x ) {
+			return Double( fp64_rsqrt( x.x ) );
+		}
+		static Double fma( const Double &a, const Double &b, const Double &c ) {
+			return Double( fp64_fma( a.x, b.x, c.x ) );
 		}
 		static Double pi() {
 			return Double(float64_NUMBER_PI);
 		}
 		static Double log( const Double &x ) {
-			Double res;
-			res.x = fp64_log( x.x );
-			return res;
+			return Double( fp64_log( x.x ) );
 		}
 		static Double exp( const Double &x ) {
-			Double res;
-			res.x = fp64_exp( x.x );
-			return res;
+			return Double( fp64_exp( x.x ) );
+		}
+		static Double log1p( const Double &x ) {
+			return Double( fp64_log1p( x.x ) );
+		}
+		static Double expm1( const Double &x ) {
+			return Double( fp64_expm1( x.x ) );
+		}
+		// may differ by 1 ulp from fp64_sin(x) and fp64_cos(x)
+		static void sincos( const Double &x, Double &s, Double &c ) {
+			fp64_sincos( x.x, &s.x, &c.x );
+		}	
+		// may differ by 1 ulp from fp64_sinh(x) and fp64_cosh(x)
+		static void sinhcosh( const Double &x, Double &s, Double &c ) {
+			fp64_sinhcosh( x.x, &s.x, &c.x );
 		}	
    private:
       float64_t x;
 };
+
+/* binary operators
+   the overloads with a Double operand also accept numbers and strings
+   that are converted to Double, e.g. "x * 2" or "0.5 + x" */
+#define DOUBLE_BINARY_OPERATOR(op, node) \
+	template<class L, class R> inline node<L,R> operator op( const DoubleExpr<L>& l, const DoubleExpr<R>& r ) \
+		{ return node<L,R>( l.self(), r.self() ); } \
+	template<class L> inline node<L,Double> operator op( const DoubleExpr<L>& l, const Double& r ) \
+		{ return node<L,Double>( l.self(), r ); } \
+	template<class R> inline node<Double,R> operator op( const Double& l, const DoubleExpr<R>& r ) \
+		{ return node<Double,R>( l, r.self() ); } \
+	inline node<Double,Double> operator op( const Double& l, const Double& r ) \
+		{ return node<Double,Double>( l, r ); }
+
+DOUBLE_BINARY_OPERATOR( +, DoubleAdd )
+DOUBLE_BINARY_OPERATOR( -, DoubleSub )
+DOUBLE_BINARY_OPERATOR( *, DoubleMul )
+DOUBLE_BINARY_OPERATOR( /, DoubleDiv )
+#undef DOUBLE_BINARY_OPERATOR
+
+template<class E> inline DoubleNeg<E> operator-( const DoubleExpr<E>& e ) {
+	return DoubleNeg<E>( e.self() );
+}
 #endif
\ No newline at end of file
@@ -66,6 +66,7 @@
 
 #define SPL_IO_ADDR	0x3D
 #define SPH_IO_ADDR	0x3E
+#define SREG_IO_ADDR	0x3F
 
 .macro	FUNCTION name
   .ifdef  .Lfunction
@@ -111,6 +112,24 @@ _U(\name):
 _U(\name):
 .endm
 
+/* Create an entry for a libm function, like libf7 of libgcc does:
+   __name is always defined, name resp. namel are defined as weak
+   aliases if double resp. long double is 64 bit (-mdouble=64,
+   -mlong-double=64), so that fp64lib serves as backend for the
+   native double type. With 32 bit double the plain names are left
+   to the float functions of avr-libc. */
+.macro	LIBM_ENTRY name
+	GCC_ENTRY __\name
+#if defined(__SIZEOF_DOUBLE__) && __SIZEOF_DOUBLE__ == 8
+	.weak	_U(\name)
+_U(\name):
+#endif
+#if defined(__SIZEOF_LONG_DOUBLE__) && __SIZEOF_LONG_DOUBLE__ == 8
+	.weak	_U(\name\()l)
+_U(\name\()l):
+#endif
+.endm
+
 .macro	ENDFUNC
 .LEND:
 .endm
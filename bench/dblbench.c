@@ -0,0 +1,249 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* dblbench.c
+   Cycle count benchmark for the native double type of avr-gcc with
+   -mdouble=64. The program uses only plain double arithmetic, casts and
+   the functions of math.h, so it does not know which library does the
+   work. "make dblbench" builds it twice and runs both within simavr:
+     fp64lib	linked against libfp64d64-$(MCU).a, i.e. fp64lib serves
+				as backend via __adddf3 etc. and the libm names
+     libf7		linked against the toolchain only, i.e. the 64 bit double
+				support of libgcc (libf7) and avr-libc
+
+   Cycles are measured as in fp64bench.c. Every operation is wrapped in a
+   small function double f(double x, double y), so the figures include
+   the call of the wrapper, which is the same for both backends.
+
+   Output is one comma separated line per operation and input set:
+     mcu,backend,function,set,n,min,avg,max
+   and the makefile collects both runs in bench/dblbench-$(MCU).csv.
+*/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#if __SIZEOF_DOUBLE__ != 8
+#error "dblbench.c has to be compiled with -mdouble=64"
+#endif
+
+#ifndef BENCH_MCU
+#define BENCH_MCU "avr"
+#endif
+#ifndef BENCH_BACKEND
+#define BENCH_BACKEND "default"
+#endif
+
+volatile double bench_sink;
+volatile long bench_sinkl;
+volatile float bench_sinkf;
+volatile long bench_l = -123456789L;
+volatile float bench_f = 3.1415927f;
+
+/* list of all benchmarked operations, x and y are x[i] and x[i+1]
+   of the same input set */
+#define BENCH_FUNCTIONS \
+	X(add, x + y) \
+	X(sub, x - y) \
+	X(mul, x * y) \
+	X(div, x / y) \
+	X(lt, x < y ? x : y) \
+	X(eq, x == y ? x : y) \
+	X(tolong, (bench_sinkl = (long) x, y)) \
+	X(fromlong, (double) bench_l) \
+	X(tofloat, (bench_sinkf = (float) x, y)) \
+	X(fromfloat, (double) bench_f) \
+	X(sqrt, sqrt(x)) \
+	X(floor, floor(x)) \
+	X(round, round(x)) \
+	X(fmod, fmod(x, y)) \
+	X(hypot, hypot(x, y)) \
+	X(sin, sin(x)) \
+	X(cos, cos(x)) \
+	X(tan, tan(x)) \
+	X(asin, asin(x)) \
+	X(acos, acos(x)) \
+	X(atan, atan(x)) \
+	X(atan2, atan2(x, y)) \
+	X(exp, exp(x)) \
+	X(log, log(x)) \
+	X(log10, log10(x)) \
+	X(pow, pow(x, y)) \
+	X(sinh, sinh(x)) \
+	X(cosh, cosh(x)) \
+	X(tanh, tanh(x))
+
+typedef double (*bench_fn_t)(double, double);
+
+typedef struct {
+	const char *name;	// name of operation, in PROGMEM
+	bench_fn_t fn;
+} bench_func_t;
+
+#define X(f, expr) \
+	static const char bench_name_##f[] PROGMEM = #f; \
+	static double __attribute__((noinline)) bench_##f(double x, double y) \
+		{ (void) x; (void) y; return expr; }
+BENCH_FUNCTIONS
+#undef X
+
+static const bench_func_t bench_funcs[] PROGMEM = {
+#define X(f, expr) { bench_name_##f, bench_##f },
+BENCH_FUNCTIONS
+#undef X
+};
+
+/* input sets: same values as "normal" in fp64bench.c and
+   values within [-1,1] for asin and acos */
+#define BENCH_SET_SIZE	8
+
+static const double bench_normal[BENCH_SET_SIZE] PROGMEM = {
+	1.0, -2.5, 3.141592653589793, 0.1,
+	12345.678, -7250.0, 1e-10, 0.6666666666666666
+};
+static const double bench_unit[BENCH_SET_SIZE] PROGMEM = {
+	0.5, -0.25, 0.9, 1e-3, -0.75, 0.1, 0.3333333333333333, -0.999
+};
+
+typedef struct {
+	const char *name;	// name of input set, in PROGMEM
+	const double *x;	// values, in PROGMEM
+} bench_set_t;
+
+static const char bench_name_normal[] PROGMEM = "normal";
+static const char bench_name_unit[] PROGMEM = "unit";
+
+static const bench_set_t bench_sets[] PROGMEM = {
+	{ bench_name_normal, bench_normal },
+	{ bench_name_unit, bench_unit },
+};
+
+#define ARRAY_SIZE(a)	(sizeof(a)/sizeof((a)[0]))
+
+/* cycle counter: timer 1 at full cpu clock plus software overflow count */
+static volatile uint16_t bench_ovf;
+static uint16_t bench_overhead;
+
+ISR(TIMER1_OVF_vect)
+{
+	bench_ovf++;
+}
+
+static uint32_t __attribute__((noinline)) bench_now(void)
+{
+	uint16_t t, ovf;
+	uint8_t sreg = SREG;
+
+	cli();
+	t = TCNT1;
+	ovf = bench_ovf;
+	if( (TIFR1 & _BV(TOV1)) && t < 0x8000 )
+		ovf++;	// overflow pending but not yet serviced
+	SREG = sreg;
+	return ((uint32_t) ovf << 16) | t;
+}
+
+static void bench_init(void)
+{
+	TCCR1A = 0;
+	TCNT1 = 0;
+	TIFR1 = _BV(TOV1);
+	TIMSK1 = _BV(TOIE1);
+	TCCR1B = _BV(CS10);	// clk/1
+	sei();
+
+	uint32_t t0 = bench_now();
+	uint32_t t1 = bench_now();
+	bench_overhead = (uint16_t) (t1 - t0);
+}
+
+/* output via uart 0, simavr echoes the transmitted lines */
+static int bench_putchar(char c, FILE *stream)
+{
+	loop_until_bit_is_set(UCSR0A, UDRE0);
+	UCSR0A |= _BV(TXC0);	// clear "transmit complete" of previous char
+	UDR0 = c;
+	return 0;
+}
+
+static FILE bench_out = FDEV_SETUP_STREAM(bench_putchar, NULL, _FDEV_SETUP_WRITE);
+
+/* measure one call of fn with input i of set */
+static uint32_t bench_one(bench_fn_t fn, const bench_set_t *set, uint8_t i)
+{
+	double x, y;
+	uint32_t t0, t1;
+
+	memcpy_P(&x, &set->x[i], sizeof(x));
+	memcpy_P(&y, &set->x[(i+1) % BENCH_SET_SIZE], sizeof(y));
+
+	t0 = bench_now();
+	bench_sink = fn(x, y);
+	t1 = bench_now();
+	return t1 - t0 - bench_overhead;
+}
+
+int main(void)
+{
+	bench_init();
+	UCSR0B = _BV(TXEN0);
+
+	fputs_P(PSTR("mcu,backend,function,set,n,min,avg,max\n"), &bench_out);
+	for( uint8_t f = 0; f < ARRAY_SIZE(bench_funcs); f++ ) {
+		bench_func_t func;
+		memcpy_P(&func, &bench_funcs[f], sizeof(func));
+		for( uint8_t s = 0; s < ARRAY_SIZE(bench_sets); s++ ) {
+			bench_set_t set;
+			uint32_t min = UINT32_MAX, max = 0, sum = 0;
+			memcpy_P(&set, &bench_sets[s], sizeof(set));
+			for( uint8_t i = 0; i < BENCH_SET_SIZE; i++ ) {
+				uint32_t c = bench_one(func.fn, &set, i);
+				if( c < min ) min = c;
+				if( c > max ) max = c;
+				sum += c;
+			}
+			fprintf_P(&bench_out, PSTR(BENCH_MCU "," BENCH_BACKEND ",%S,%S,%u,%lu,%lu,%lu\n"),
+				func.name, set.name, BENCH_SET_SIZE, min, (sum + BENCH_SET_SIZE/2) / BENCH_SET_SIZE, max);
+		}
+	}
+
+	// simavr terminates when sleeping with interrupts disabled
+	loop_until_bit_is_set(UCSR0A, TXC0);
+	cli();
+	sleep_enable();
+	sleep_cpu();
+	for(;;)
+		;
+}
@@ -0,0 +1,632 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64bench.c
+   Cycle count benchmark for the fp64lib entry points. The harness is
+   built against libfp64-$(MCU).a and run within simavr via "make bench".
+
+   Cycles are measured with timer 1 running at the cpu clock (prescaler 1),
+   overflows are counted in an interrupt to allow for calls longer than
+   65535 cycles. The cost of reading the timer is measured at startup and
+   subtracted from every sample, so the figures include the call itself,
+   argument passing and the return, but nothing else. Samples longer
+   than 65535 cycles also contain the overflow interrupt (~40 cycles).
+
+   Output is one comma separated line per function and input set:
+     mcu,function,set,n,min,avg,max
+   The batch functions (fp64_add_n etc.) are measured once over a whole
+   input set and reported as cycles per element, together with the
+   equivalent loop of scalar calls ("loop_add" etc.) for comparison.
+   The sorting and clamping loops are measured the same way, once with
+   calls of fp64_compare, fp64_fmin and fp64_fmax ("sort_call" etc.) and
+   once with the inline versions of fp64inline.h ("sort_inline" etc.).
+   The makefile strips the simavr decoration from the uart output and
+   stores the table in bench/fp64bench-$(MCU).csv.
+*/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <stdio.h>
+#include <string.h>
+#include "fp64inline.h"
+
+#ifndef BENCH_MCU
+#define BENCH_MCU "avr"
+#endif
+
+/* kinds of entry points, selects how the function is called */
+#define BENCH_UNARY		0	// float64_t f(float64_t x)
+#define BENCH_BINARY	1	// float64_t f(float64_t x, float64_t y)
+#define BENCH_STRTOD	2	// float64_t fp64_strtod(char *s, char **endp)
+#define BENCH_TOSTRING	3	// char *fp64_to_string(float64_t x, 17, 0)
+#define BENCH_TERNARY	4	// float64_t f(float64_t x, float64_t y, float64_t z)
+#define BENCH_DECEXP	5	// char *fp64_to_decimalExp(float64_t x, 17, 0, NULL)
+#define BENCH_SHORTEST	6	// char *fp64_to_decimalExp(float64_t x, FP64_SHORTEST, 0, NULL)
+#define BENCH_SINCOS	7	// void fp64_sincos(float64_t x, float64_t *s, float64_t *c)
+#define BENCH_POWI		8	// float64_t fp64_powi(float64_t x, int n), n = 3*i - 10
+#define BENCH_SINHCOSH	9	// void fp64_sinhcosh(float64_t x, float64_t *s, float64_t *c)
+#define BENCH_POLY		10	// float64_t fp64_poly(float64_t x, bench_poly, 8)
+#define BENCH_POLYLOOP	11	// same polynom with one fp64_mul and fp64_add per term
+
+// name for fp64_to_decimalExp in shortest mode in the result table
+#define fp64_to_shortest	fp64_to_decimalExp
+// name for the polynom evaluated by fp64_mul and fp64_add in the result table
+#define loop_poly			fp64_poly
+
+/* list of all benchmarked functions
+   binary functions are called with x[i] and x[i+1] of the same input set */
+#define BENCH_FUNCTIONS \
+	X(fp64_add, BENCH_BINARY) \
+	X(fp64_sub, BENCH_BINARY) \
+	X(fp64_mul, BENCH_BINARY) \
+	X(fp64_div, BENCH_BINARY) \
+	X(fp64_fma, BENCH_TERNARY) \
+	X(fp64_fmod, BENCH_BINARY) \
+	X(fp64_inverse, BENCH_UNARY) \
+	X(fp64_sqrt, BENCH_UNARY) \
+	X(fp64_rsqrt, BENCH_UNARY) \
+	X(fp64_square, BENCH_UNARY) \
+	X(fp64_cbrt, BENCH_UNARY) \
+	X(fp64_hypot, BENCH_BINARY) \
+	X(fp64_hypot3, BENCH_TERNARY) \
+	X(fp64_sin, BENCH_UNARY) \
+	X(fp64_cos, BENCH_UNARY) \
+	X(fp64_sin_fast, BENCH_UNARY) \
+	X(fp64_cos_fast, BENCH_UNARY) \
+	X(fp64_sincos, BENCH_SINCOS) \
+	X(fp64_tan, BENCH_UNARY) \
+	X(fp64_asin, BENCH_UNARY) \
+	X(fp64_acos, BENCH_UNARY) \
+	X(fp64_atan, BENCH_UNARY) \
+	X(fp64_atan_fast, BENCH_UNARY) \
+	X(fp64_atan2, BENCH_BINARY) \
+	X(fp64_exp, BENCH_UNARY) \
+	X(fp64_exp_fast, BENCH_UNARY) \
+	X(fp64_expm1, BENCH_UNARY) \
+	X(fp64_exp2, BENCH_UNARY) \
+	X(fp64_exp10, BENCH_UNARY) \
+	X(fp64_log, BENCH_UNARY) \
+	X(fp64_log_fast, BENCH_UNARY) \
+	X(fp64_log1p, BENCH_UNARY) \
+	X(fp64_log2, BENCH_UNARY) \
+	X(fp64_log10, BENCH_UNARY) \
+	X(fp64_pow, BENCH_BINARY) \
+	X(fp64_powi, BENCH_POWI) \
+	X(fp64_sinh, BENCH_UNARY) \
+	X(fp64_cosh, BENCH_UNARY) \
+	X(fp64_sinhcosh, BENCH_SINHCOSH) \
+	X(fp64_tanh, BENCH_UNARY) \
+	X(fp64_asinh, BENCH_UNARY) \
+	X(fp64_acosh, BENCH_UNARY) \
+	X(fp64_atanh, BENCH_UNARY) \
+	X(fp64_poly, BENCH_POLY) \
+	X(loop_poly, BENCH_POLYLOOP) \
+	X(fp64_strtod, BENCH_STRTOD) \
+	X(fp64_to_string, BENCH_TOSTRING) \
+	X(fp64_to_decimalExp, BENCH_DECEXP) \
+	X(fp64_to_shortest, BENCH_SHORTEST)
+
+typedef void (*bench_fn_t)(void);
+typedef float64_t (*bench_unary_t)(float64_t);
+typedef float64_t (*bench_binary_t)(float64_t, float64_t);
+typedef float64_t (*bench_ternary_t)(float64_t, float64_t, float64_t);
+
+typedef struct {
+	const char *name;	// name of function, in PROGMEM
+	uint8_t kind;		// BENCH_xxx
+	bench_fn_t fn;
+} bench_func_t;
+
+#define X(f, kind) static const char bench_name_##f[] PROGMEM = #f;
+BENCH_FUNCTIONS
+#undef X
+
+static const bench_func_t bench_funcs[] PROGMEM = {
+#define X(f, kind) { bench_name_##f, kind, (bench_fn_t) f },
+BENCH_FUNCTIONS
+#undef X
+};
+
+/* taylor polynom of exp(x) of degree 8, c[i] = 1/(8-i)! */
+static const fp64_coeff_t bench_poly[9] PROGMEM = {
+	FP64_COEFF(0x3efa01a01a01a01aLLU), FP64_COEFF(0x3f2a01a01a01a01aLLU),
+	FP64_COEFF(0x3f56c16c16c16c17LLU), FP64_COEFF(0x3f81111111111111LLU),
+	FP64_COEFF(0x3fa5555555555555LLU), FP64_COEFF(0x3fc5555555555555LLU),
+	FP64_COEFF(0x3fe0000000000000LLU), FP64_COEFF(0x3ff0000000000000LLU),
+	FP64_COEFF(0x3ff0000000000000LLU)
+};
+static const float64_t bench_poly_c[9] PROGMEM = {
+	0x3efa01a01a01a01aLLU, 0x3f2a01a01a01a01aLLU, 0x3f56c16c16c16c17LLU,
+	0x3f81111111111111LLU, 0x3fa5555555555555LLU, 0x3fc5555555555555LLU,
+	0x3fe0000000000000LLU, 0x3ff0000000000000LLU, 0x3ff0000000000000LLU
+};
+
+/* input sets, each given as bit patterns and as the strings for fp64_strtod */
+#define BENCH_SET_SIZE	8
+
+static const float64_t bench_normal[BENCH_SET_SIZE] PROGMEM = {
+	0x3ff0000000000000LLU,	// 1.0
+	0xc004000000000000LLU,	// -2.5
+	0x400921fb54442d18LLU,	// 3.141592653589793
+	0x3fb999999999999aLLU,	// 0.1
+	0x40c81cd6c8b43958LLU,	// 12345.678
+	0xc0bc520000000000LLU,	// -7250.0
+	0x3ddb7cdfd9d7bdbbLLU,	// 1e-10
+	0x3fe5555555555555LLU	// 0.6666666666666666
+};
+static const char bench_normal_s[BENCH_SET_SIZE][24] PROGMEM = {
+	"1.0", "-2.5", "3.141592653589793", "0.1",
+	"12345.678", "-7250.0", "1e-10", "0.6666666666666666"
+};
+
+static const float64_t bench_subnormal[BENCH_SET_SIZE] PROGMEM = {
+	0x0000000000000001LLU,	// 5e-324
+	0x000fffffffffffffLLU,	// 2.225073858507201e-308
+	0x0008000000000000LLU,	// 1.1125369292536007e-308
+	0x8000000000001234LLU,	// -2.3023e-320
+	0x0000000100000000LLU,	// 2.121995791e-314
+	0x800aaaaaaaaaaaaaLLU,	// -1.483382572338134e-308
+	0x0000000000000001LLU,	// 5e-324
+	0x000fffffffffffffLLU	// 2.225073858507201e-308
+};
+static const char bench_subnormal_s[BENCH_SET_SIZE][24] PROGMEM = {
+	"5e-324", "2.225073858507201e-308", "1.1125369292536007e-308", "-2.3023e-320",
+	"2.121995791e-314", "-1.483382572338134e-308", "4.9406564584124654e-324", "2.2250738585072009e-308"
+};
+
+static const float64_t bench_overflow[BENCH_SET_SIZE] PROGMEM = {
+	0x7fefffffffffffffLLU,	// 1.7976931348623157e+308
+	0x7fe0000000000000LLU,	// 8.98846567431158e+307
+	0xffe1ccf385ebc8a0LLU,	// -1e+308
+	0x7fd5555555555555LLU,	// 5.992310449541053e+307
+	0x7fdccccccccccccdLLU,	// 8.089619106880422e+307
+	0xffc0000000000000LLU,	// -2.247116418577895e+307
+	0x7e37e43c8800759cLLU,	// 1e+300
+	0x7fefffffffffffffLLU	// 1.7976931348623157e+308
+};
+static const char bench_overflow_s[BENCH_SET_SIZE][24] PROGMEM = {
+	"1.7976931348623157e+308", "8.98846567431158e+307", "-1e+308", "5.992310449541053e+307",
+	"8.089619106880422e+307", "-2.247116418577895e+307", "1e+300", "1.7976931348623157e308"
+};
+
+static const float64_t bench_midtrig[BENCH_SET_SIZE] PROGMEM = {
+	0x4000000000000000LLU,	// 2.0
+	0xc008000000000000LLU,	// -3.0
+	0x4024000000000000LLU,	// 10.0
+	0x4059000000000000LLU,	// 100.0
+	0xc0f86a0000000000LLU,	// -100000.0
+	0x412e848000000000LLU,	// 1000000.0
+	0xc19d6f34547df3b6LLU,	// -123456789.123
+	0x41edcd6500000000LLU	// 4000000000.0
+};
+static const char bench_midtrig_s[BENCH_SET_SIZE][24] PROGMEM = {
+	"2.0", "-3.0", "10.0", "100.0",
+	"-100000.0", "1000000.0", "-123456789.123", "4000000000.0"
+};
+
+static const float64_t bench_hugetrig[BENCH_SET_SIZE] PROGMEM = {
+	0xc26d1a94a2000000LLU,	// -1000000000000.0
+	0xc202a05f20000000LLU,	// -10000000000.0
+	0x430c6bf526340000LLU,	// 1e15
+	0x4480f0cf064dd592LLU,	// 1e22
+	0x43b0000000000000LLU,	// 2^60
+	0x54b249ad2594c37dLLU,	// 1e100
+	0xe974e718d7d7625aLLU,	// -1e200
+	0x7e37e43c8800759cLLU	// 1e300
+};
+static const char bench_hugetrig_s[BENCH_SET_SIZE][24] PROGMEM = {
+	"-1000000000000.0", "-10000000000.0", "1e15", "1e+22",
+	"1152921504606846976", "1e100", "-1e200", "1e300"
+};
+
+static const float64_t bench_telemetry[BENCH_SET_SIZE] PROGMEM = {
+	0x4037733333333333LLU,	// 23.45
+	0xbf547ae147ae147bLLU,	// -0.00125
+	0x408faa0000000000LLU,	// 1013.25
+	0x400a666666666666LLU,	// 3.3
+	0x40478fcd67fd3f5bLLU,	// 47.123456
+	0xc05e9ad7b634dad3LLU,	// -122.419416
+	0x3eef75104d551d69LLU,	// 1.5e-05
+	0x44dfe185ca57c517LLU	// 6.02214076e+23
+};
+static const char bench_telemetry_s[BENCH_SET_SIZE][24] PROGMEM = {
+	"23.45", "-0.00125", "1013.25", "3.3",
+	"47.123456", "-122.419416", "0.000015", "6.02214076e23"
+};
+
+typedef struct {
+	const char *name;	// name of input set, in PROGMEM
+	const float64_t *x;	// values, in PROGMEM
+	const char (*s)[24];// same values as strings, in PROGMEM
+} bench_set_t;
+
+static const char bench_name_normal[] PROGMEM = "normal";
+static const char bench_name_subnormal[] PROGMEM = "subnormal";
+static const char bench_name_overflow[] PROGMEM = "overflow";
+static const char bench_name_midtrig[] PROGMEM = "midtrig";
+static const char bench_name_hugetrig[] PROGMEM = "hugetrig";
+static const char bench_name_telemetry[] PROGMEM = "telemetry";
+
+static const bench_set_t bench_sets[] PROGMEM = {
+	{ bench_name_normal, bench_normal, bench_normal_s },
+	{ bench_name_subnormal, bench_subnormal, bench_subnormal_s },
+	{ bench_name_overflow, bench_overflow, bench_overflow_s },
+	{ bench_name_midtrig, bench_midtrig, bench_midtrig_s },
+	{ bench_name_hugetrig, bench_hugetrig, bench_hugetrig_s },
+	{ bench_name_telemetry, bench_telemetry, bench_telemetry_s },
+};
+
+#define ARRAY_SIZE(a)	(sizeof(a)/sizeof((a)[0]))
+
+/* cycle counter: timer 1 at full cpu clock plus software overflow count */
+static volatile uint16_t bench_ovf;
+static uint16_t bench_overhead;
+
+ISR(TIMER1_OVF_vect)
+{
+	bench_ovf++;
+}
+
+static uint32_t __attribute__((noinline)) bench_now(void)
+{
+	uint16_t t, ovf;
+	uint8_t sreg = SREG;
+
+	cli();
+	t = TCNT1;
+	ovf = bench_ovf;
+	if( (TIFR1 & _BV(TOV1)) && t < 0x8000 )
+		ovf++;	// overflow pending but not yet serviced
+	SREG = sreg;
+	return ((uint32_t) ovf << 16) | t;
+}
+
+static void bench_init(void)
+{
+	TCCR1A = 0;
+	TCNT1 = 0;
+	TIFR1 = _BV(TOV1);
+	TIMSK1 = _BV(TOIE1);
+	TCCR1B = _BV(CS10);	// clk/1
+	sei();
+
+	uint32_t t0 = bench_now();
+	uint32_t t1 = bench_now();
+	bench_overhead = (uint16_t) (t1 - t0);
+}
+
+/* output via uart 0, simavr echoes the transmitted lines */
+static int bench_putchar(char c, FILE *stream)
+{
+	loop_until_bit_is_set(UCSR0A, UDRE0);
+	UCSR0A |= _BV(TXC0);	// clear "transmit complete" of previous char
+	UDR0 = c;
+	return 0;
+}
+
+static FILE bench_out = FDEV_SETUP_STREAM(bench_putchar, NULL, _FDEV_SETUP_WRITE);
+
+volatile float64_t bench_sink;
+char * volatile bench_sinkp;
+float64_t bench_sinkcs[2];
+float64_t bench_c[9];
+
+/* measure one call of function fn of the given kind, input i of set */
+static uint32_t bench_one(uint8_t kind, bench_fn_t fn, const bench_set_t *set, uint8_t i)
+{
+	float64_t x, y, z;
+	char buf[32];
+	char *endp;
+	uint32_t t0, t1;
+
+	memcpy_P(&x, &set->x[i], sizeof(x));
+	memcpy_P(&y, &set->x[(i+1) % BENCH_SET_SIZE], sizeof(y));
+	memcpy_P(&z, &set->x[(i+2) % BENCH_SET_SIZE], sizeof(z));
+	strcpy_P(buf, set->s[i]);
+
+	switch( kind ) {
+	case BENCH_UNARY:
+		t0 = bench_now();
+		bench_sink = ((bench_unary_t) fn)(x);
+		t1 = bench_now();
+		break;
+	case BENCH_BINARY:
+		t0 = bench_now();
+		bench_sink = ((bench_binary_t) fn)(x, y);
+		t1 = bench_now();
+		break;
+	case BENCH_TERNARY:
+		t0 = bench_now();
+		bench_sink = ((bench_ternary_t) fn)(x, y, z);
+		t1 = bench_now();
+		break;
+	case BENCH_STRTOD:
+		t0 = bench_now();
+		bench_sink = fp64_strtod(buf, &endp);
+		t1 = bench_now();
+		break;
+	case BENCH_DECEXP:
+		t0 = bench_now();
+		bench_sinkp = fp64_to_decimalExp(x, 17, 0, NULL);
+		t1 = bench_now();
+		break;
+	case BENCH_SHORTEST:
+		t0 = bench_now();
+		bench_sinkp = fp64_to_decimalExp(x, FP64_SHORTEST, 0, NULL);
+		t1 = bench_now();
+		break;
+	case BENCH_SINCOS:
+		t0 = bench_now();
+		fp64_sincos(x, &bench_sinkcs[0], &bench_sinkcs[1]);
+		t1 = bench_now();
+		break;
+	case BENCH_SINHCOSH:
+		t0 = bench_now();
+		fp64_sinhcosh(x, &bench_sinkcs[0], &bench_sinkcs[1]);
+		t1 = bench_now();
+		break;
+	case BENCH_POWI:
+		t0 = bench_now();
+		bench_sink = fp64_powi(x, 3*i - 10);
+		t1 = bench_now();
+		break;
+	case BENCH_POLY:
+		t0 = bench_now();
+		bench_sink = fp64_poly(x, bench_poly, 8);
+		t1 = bench_now();
+		break;
+	case BENCH_POLYLOOP:
+		memcpy_P(bench_c, bench_poly_c, sizeof(bench_c));
+		t0 = bench_now();
+		y = bench_c[0];
+		for( uint8_t k = 1; k < 9; k++ )
+			y = fp64_add(fp64_mul(y, x), bench_c[k]);
+		bench_sink = y;
+		t1 = bench_now();
+		break;
+	default: // BENCH_TOSTRING
+		t0 = bench_now();
+		bench_sinkp = fp64_to_string(x, 17, 0);
+		t1 = bench_now();
+		break;
+	}
+	return t1 - t0 - bench_overhead;
+}
+
+/* print one line of the result table */
+static void bench_report(const char *name, const char *setname, uint8_t n, uint32_t min, uint32_t sum, uint32_t max)
+{
+	fprintf_P(&bench_out, PSTR(BENCH_MCU ",%S,%S,%u,%lu,%lu,%lu\n"),
+		name, setname, n, min, (sum + n/2) / n, max);
+}
+
+/* batch functions and the equivalent loops of scalar calls */
+#define BENCH_BATCH_FUNCTIONS \
+	X(fp64_add_n, loop_add) \
+	X(fp64_mul_n, loop_mul) \
+	X(fp64_scale_n, loop_scale) \
+	X(fp64_axpy, loop_axpy) \
+	X(fp64_dot, loop_dot)
+
+#define X(f, loop) static const char bench_name_##f[] PROGMEM = #f; \
+	static const char bench_name_##loop[] PROGMEM = #loop;
+BENCH_BATCH_FUNCTIONS
+#undef X
+
+static const char * const bench_batch_names[][2] PROGMEM = {
+#define X(f, loop) { bench_name_##f, bench_name_##loop },
+BENCH_BATCH_FUNCTIONS
+#undef X
+};
+
+static float64_t bench_a[BENCH_SET_SIZE], bench_b[BENCH_SET_SIZE], bench_r[BENCH_SET_SIZE];
+
+/* measure batch function f (loop = 0) or the loop of scalar calls (loop = 1)
+   over all elements of the arrays bench_a and bench_b */
+static uint32_t bench_batch_one(uint8_t f, uint8_t loop)
+{
+	float64_t s = bench_a[0];
+	float64_t sum;
+	uint32_t t0, t1;
+	uint8_t i;
+
+	t0 = bench_now();
+	switch( f*2 + loop ) {
+	case 0:
+		fp64_add_n(bench_r, bench_a, bench_b, BENCH_SET_SIZE);
+		break;
+	case 1:
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			bench_r[i] = fp64_add(bench_a[i], bench_b[i]);
+		break;
+	case 2:
+		fp64_mul_n(bench_r, bench_a, bench_b, BENCH_SET_SIZE);
+		break;
+	case 3:
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			bench_r[i] = fp64_mul(bench_a[i], bench_b[i]);
+		break;
+	case 4:
+		fp64_scale_n(bench_r, bench_a, s, BENCH_SET_SIZE);
+		break;
+	case 5:
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			bench_r[i] = fp64_mul(bench_a[i], s);
+		break;
+	case 6:
+		fp64_axpy(bench_r, bench_a, s, BENCH_SET_SIZE);
+		break;
+	case 7:
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			bench_r[i] = fp64_add(fp64_mul(s, bench_a[i]), bench_r[i]);
+		break;
+	case 8:
+		bench_sink = fp64_dot(bench_a, bench_b, BENCH_SET_SIZE);
+		break;
+	default: // 9
+		sum = 0;
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			sum = fp64_add(sum, fp64_mul(bench_a[i], bench_b[i]));
+		bench_sink = sum;
+		break;
+	}
+	t1 = bench_now();
+	return t1 - t0 - bench_overhead;
+}
+
+/* report cycles per element of all batch functions for one input set,
+   b[i] is a[i+1] as for the binary functions */
+static void bench_batch(const bench_set_t *set)
+{
+	for( uint8_t i = 0; i < BENCH_SET_SIZE; i++ ) {
+		memcpy_P(&bench_a[i], &set->x[i], sizeof(float64_t));
+		memcpy_P(&bench_b[i], &set->x[(i+1) % BENCH_SET_SIZE], sizeof(float64_t));
+	}
+	for( uint8_t f = 0; f < ARRAY_SIZE(bench_batch_names); f++ ) {
+		for( uint8_t loop = 0; loop < 2; loop++ ) {
+			const char *name = (const char *) pgm_read_word(&bench_batch_names[f][loop]);
+			memcpy(bench_r, bench_b, sizeof(bench_r));	// y of fp64_axpy
+			uint32_t c = (bench_batch_one(f, loop) + BENCH_SET_SIZE/2) / BENCH_SET_SIZE;
+			bench_report(name, set->name, BENCH_SET_SIZE, c, c * BENCH_SET_SIZE, c);
+		}
+	}
+}
+
+/* sorting and clamping loops, with calls of the library functions
+   (name in parentheses) and with the inline versions */
+#define BENCH_LOOP_FUNCTIONS \
+	X(sort_call) \
+	X(sort_inline) \
+	X(clamp_call) \
+	X(clamp_inline)
+
+#define X(f) static const char bench_name_##f[] PROGMEM = #f;
+BENCH_LOOP_FUNCTIONS
+#undef X
+
+static const char * const bench_loop_names[] PROGMEM = {
+#define X(f) bench_name_##f,
+BENCH_LOOP_FUNCTIONS
+#undef X
+};
+
+/* measure loop f over all elements of the array bench_a,
+   insertion sort into bench_r resp. clamp to [-100, 100] */
+static uint32_t bench_loop_one(uint8_t f)
+{
+	const float64_t lo = 0xc059000000000000LLU;	// -100.0
+	const float64_t hi = 0x4059000000000000LLU;	// 100.0
+	float64_t x;
+	uint32_t t0, t1;
+	uint8_t i, j;
+
+	memcpy(bench_r, bench_a, sizeof(bench_r));
+	t0 = bench_now();
+	switch( f ) {
+	case 0:
+		for( i = 1; i < BENCH_SET_SIZE; i++ ) {
+			x = bench_r[i];
+			for( j = i; j > 0 && (fp64_compare)(bench_r[j-1], x) > 0; j-- )
+				bench_r[j] = bench_r[j-1];
+			bench_r[j] = x;
+		}
+		break;
+	case 1:
+		for( i = 1; i < BENCH_SET_SIZE; i++ ) {
+			x = bench_r[i];
+			for( j = i; j > 0 && fp64_compare(bench_r[j-1], x) > 0; j-- )
+				bench_r[j] = bench_r[j-1];
+			bench_r[j] = x;
+		}
+		break;
+	case 2:
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			bench_r[i] = (fp64_fmin)((fp64_fmax)(bench_a[i], lo), hi);
+		break;
+	default: // 3
+		for( i = 0; i < BENCH_SET_SIZE; i++ )
+			bench_r[i] = fp64_fmin(fp64_fmax(bench_a[i], lo), hi);
+		break;
+	}
+	t1 = bench_now();
+	return t1 - t0 - bench_overhead;
+}
+
+/* report cycles per element of the loops for one input set */
+static void bench_loop(const bench_set_t *set)
+{
+	for( uint8_t i = 0; i < BENCH_SET_SIZE; i++ )
+		memcpy_P(&bench_a[i], &set->x[i], sizeof(float64_t));
+	for( uint8_t f = 0; f < ARRAY_SIZE(bench_loop_names); f++ ) {
+		const char *name = (const char *) pgm_read_word(&bench_loop_names[f]);
+		uint32_t c = (bench_loop_one(f) + BENCH_SET_SIZE/2) / BENCH_SET_SIZE;
+		bench_report(name, set->name, BENCH_SET_SIZE, c, c * BENCH_SET_SIZE, c);
+	}
+}
+
+int main(void)
+{
+	bench_init();
+	UCSR0B = _BV(TXEN0);
+
+	fputs_P(PSTR("mcu,function,set,n,min,avg,max\n"), &bench_out);
+	for( uint8_t f = 0; f < ARRAY_SIZE(bench_funcs); f++ ) {
+		bench_func_t func;
+		memcpy_P(&func, &bench_funcs[f], sizeof(func));
+		for( uint8_t s = 0; s < ARRAY_SIZE(bench_sets); s++ ) {
+			bench_set_t set;
+			uint32_t min = UINT32_MAX, max = 0, sum = 0;
+			memcpy_P(&set, &bench_sets[s], sizeof(set));
+			for( uint8_t i = 0; i < BENCH_SET_SIZE; i++ ) {
+				uint32_t c = bench_one(func.kind, func.fn, &set, i);
+				if( c < min ) min = c;
+				if( c > max ) max = c;
+				sum += c;
+			}
+			bench_report(func.name, set.name, BENCH_SET_SIZE, min, sum, max);
+		}
+	}
+	for( uint8_t s = 0; s < ARRAY_SIZE(bench_sets); s++ ) {
+		bench_set_t set;
+		memcpy_P(&set, &bench_sets[s], sizeof(set));
+		bench_batch(&set);
+		bench_loop(&set);
+	}
+
+	// simavr terminates when sleeping with interrupts disabled
+	loop_until_bit_is_set(UCSR0A, TXC0);
+	cli();
+	sleep_enable();
+	sleep_cpu();
+	for(;;)
+		;
+}
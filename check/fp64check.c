@@ -0,0 +1,374 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64check.c
+   Cross check of the AVR library against the host build libfp64host.a.
+   The same program is compiled for the AVR and, with FP64_HOST defined,
+   for the host. "make crosscheck" runs the AVR version within simavr and
+   the host version natively and diffs both outputs, which have to be
+   identical.
+
+   Every function of CHECK_FUNCTIONS is called with the values of
+   fp64check.def (see there) and then with CHECK_SWEEP pseudo random
+   arguments. The random generator is restarted for every function, so
+   the arguments of a function do not depend on the functions before.
+
+   Output is one comma separated line per call:
+     function,x[,y[,z]],result
+   with x, y, z and numerical results as 16 hex digits of their bit
+   pattern, integer results are sign extended to 64 bit, strings are
+   enclosed in "".
+
+   On the host, the number of random arguments can be given as first
+   parameter, e.g. "check/fp64check-host 10000000" for a long run.
+*/
+
+#ifdef FP64_HOST
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define PROGMEM
+#define memcpy_P(d, s, n)	memcpy(d, s, n)
+#define pgm_read_byte(p)	(*(const uint8_t *) (p))
+#define PSTR(s)				(s)
+#else
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <string.h>
+#endif
+#include "fp64lib.h"
+
+#ifndef CHECK_SWEEP
+#define CHECK_SWEEP		500
+#endif
+#define CHECK_SEED		0x0123456789abcdefULL
+
+/* arguments of type int, long and float are taken from the high bits
+   of x or y, the results of type float as their bit pattern */
+typedef union {
+	float f;
+	uint32_t u;
+} check_float_t;
+
+static float check_float( uint32_t u )
+{
+	check_float_t c;
+	c.u = u;
+	return c.f;
+}
+
+static uint32_t check_floatbits( float f )
+{
+	check_float_t c;
+	c.f = f;
+	return c.u;
+}
+
+/* second results of fp64_frexp and fp64_modf */
+static int check_exp;
+static float64_t check_int;
+
+/* string results */
+static int16_t check_exp10;
+static char check_buf[FP64_BUFSIZE];
+static uint8_t check_pos;
+
+static void check_sink( char c, void *ctx )
+{
+	char *s = (char *) ctx;
+	s[check_pos++] = c;
+	s[check_pos] = '\0';
+}
+
+static char *check_sinkstr( float64_t x, uint8_t max_chars, uint8_t max_zeroes )
+{
+	check_pos = 0;
+	check_buf[0] = '\0';
+	fp64_to_string_sink( x, max_chars, max_zeroes, check_sink, check_buf );
+	return check_buf;
+}
+
+/* list of all checked functions
+	F1(f, expr)	unary, argument x
+	F2(f, expr)	binary, arguments x and y
+	F3(f, expr)	ternary, arguments x, y and z
+	S1(f, expr)	unary with a string as result */
+#define CHECK_FUNCTIONS \
+	F2(add, fp64_add(x, y)) \
+	F2(sub, fp64_sub(x, y)) \
+	F2(mul, fp64_mul(x, y)) \
+	F2(div, fp64_div(x, y)) \
+	F2(fmod, fp64_fmod(x, y)) \
+	F3(fma, fp64_fma(x, y, z)) \
+	F2(fmin, fp64_fmin(x, y)) \
+	F2(fmax, fp64_fmax(x, y)) \
+	F2(fdim, fp64_fdim(x, y)) \
+	F2(compare, fp64_compare(x, y)) \
+	F2(ldexp, fp64_ldexp(x, (int16_t) fp64_ilogb(y))) \
+	F2(scalbln, fp64_scalbln(x, (int32_t) (y >> 44))) \
+	F1(neg, fp64_neg(x)) \
+	F1(abs, fp64_abs(x)) \
+	F1(inverse, fp64_inverse(x)) \
+	F1(sqrt, fp64_sqrt(x)) \
+	F1(square, fp64_square(x)) \
+	F1(trunc, fp64_trunc(x)) \
+	F1(ceil, fp64_ceil(x)) \
+	F1(floor, fp64_floor(x)) \
+	F1(round, fp64_round(x)) \
+	F1(frexp, fp64_frexp(x, &check_exp)) \
+	F1(frexp_exp, (fp64_frexp(x, &check_exp), (int16_t) check_exp)) \
+	F1(modf, fp64_modf(x, &check_int)) \
+	F1(modf_int, (fp64_modf(x, &check_int), check_int)) \
+	F1(classify, (int16_t) fp64_classify(x)) \
+	F1(isinf, (int16_t) fp64_isinf(x)) \
+	F1(isnan, (int16_t) fp64_isnan(x)) \
+	F1(isfinite, (int16_t) fp64_isfinite(x)) \
+	F1(signbit, (int16_t) fp64_signbit(x)) \
+	F1(ilogb, (int16_t) fp64_ilogb(x)) \
+	F1(lround, (int32_t) fp64_lround(x)) \
+	F1(lrint, (int32_t) fp64_lrint(x)) \
+	F1(to_int64, (int64_t) fp64_to_int64(x)) \
+	F1(to_int32, (int32_t) fp64_to_int32(x)) \
+	F1(to_int16, (int16_t) fp64_to_int16(x)) \
+	F1(to_int8, (int8_t) fp64_to_int8(x)) \
+	F1(to_uint64, (uint64_t) fp64_to_uint64(x)) \
+	F1(to_uint32, (uint32_t) fp64_to_uint32(x)) \
+	F1(to_uint16, (uint16_t) fp64_to_uint16(x)) \
+	F1(to_uint8, (uint8_t) fp64_to_uint8(x)) \
+	F1(int64_to_float64, fp64_int64_to_float64((int64_t) x)) \
+	F1(uint64_to_float64, fp64_uint64_to_float64(x)) \
+	F1(int32_to_float64, fp64_int32_to_float64((int32_t) (x >> 32))) \
+	F1(uint32_to_float64, fp64_uint32_to_float64((uint32_t) (x >> 32))) \
+	F1(int16_to_float64, fp64_int16_to_float64((int16_t) (x >> 48))) \
+	F1(uint16_to_float64, fp64_uint16_to_float64((uint16_t) (x >> 48))) \
+	F1(sd, fp64_sd(check_float((uint32_t) (x >> 32)))) \
+	F1(ds, check_floatbits(fp64_ds(x))) \
+	S1(to_decimalExp, fp64_to_decimalExp(x, 17, 0, &check_exp10)) \
+	S1(shortest, fp64_to_decimalExp(x, FP64_SHORTEST, 0, &check_exp10)) \
+	S1(etoa, fp64_etoa(x, 10, 0, &check_exp10)) \
+	S1(to_string, fp64_to_string(x, 17, 5)) \
+	S1(to_string_short, fp64_to_string(x, 8, 2)) \
+	S1(to_string_r, fp64_to_string_r(x, 15, 10, check_buf, 10)) \
+	S1(to_string_sink, check_sinkstr(x, 12, 3))
+
+typedef uint64_t (*check_fn_t)(float64_t, float64_t, float64_t);
+typedef char *(*check_sfn_t)(float64_t);
+
+typedef struct {
+	const char *name;	// name of function, in PROGMEM
+	uint8_t args;		// number of arguments
+	check_fn_t fn;		// function with numerical result
+	check_sfn_t sfn;	// or function with string result
+} check_func_t;
+
+#define F1(f, expr)	F3(f, expr)
+#define F2(f, expr)	F3(f, expr)
+#define F3(f, expr) \
+	static const char check_name_##f[] PROGMEM = #f; \
+	static uint64_t check_##f( float64_t x, float64_t y, float64_t z ) \
+		{ (void) x; (void) y; (void) z; return (uint64_t) (expr); }
+#define S1(f, expr) \
+	static const char check_name_##f[] PROGMEM = #f; \
+	static char *check_##f( float64_t x ) { return expr; }
+CHECK_FUNCTIONS
+#undef F1
+#undef F2
+#undef F3
+#undef S1
+
+static const check_func_t check_funcs[] PROGMEM = {
+#define F1(f, expr)	{ check_name_##f, 1, check_##f, NULL },
+#define F2(f, expr)	{ check_name_##f, 2, check_##f, NULL },
+#define F3(f, expr)	{ check_name_##f, 3, check_##f, NULL },
+#define S1(f, expr)	{ check_name_##f, 1, NULL, check_##f },
+CHECK_FUNCTIONS
+#undef F1
+#undef F2
+#undef F3
+#undef S1
+};
+
+#define V(x)	x##LLU,
+static const float64_t check_values[] PROGMEM = {
+#include "fp64check.def"
+};
+#undef V
+
+#define ARRAY_SIZE(a)	(sizeof(a)/sizeof((a)[0]))
+#define CHECK_VALUES	ARRAY_SIZE(check_values)
+
+/* xorshift64 pseudo random numbers */
+static uint64_t check_state;
+
+static uint64_t check_xorshift( void )
+{
+	check_state ^= check_state << 13;
+	check_state ^= check_state >> 7;
+	check_state ^= check_state << 17;
+	return check_state;
+}
+
+/* pseudo random float64_t, the 2 lowest bits select the range:
+	0	any bit pattern
+	1	2^-32 <= |x| < 2^32
+	2	subnormal numbers and |x| near the overflow limit
+	3	24 bit significand and 1 <= |x| < 2^64, e.g. integers and halfway cases */
+static float64_t check_random( void )
+{
+	uint64_t r = check_xorshift();
+	uint16_t e = (uint16_t) (r >> 52) & 0x7ff;
+
+	switch( (uint8_t) r & 3 ) {
+	case 1:
+		e = 1023 - 32 + (e & 63);
+		break;
+	case 2:
+		e = (e & 4) ? 2046 - (e & 3) : (e & 3);
+		break;
+	case 3:
+		r &= 0x800ffffff0000000ULL;
+		e = 1023 + (e & 63);
+		break;
+	}
+	return (r & 0x800fffffffffffffULL) | ((uint64_t) e << 52);
+}
+
+/* output */
+#ifdef FP64_HOST
+static void check_putc( char c )
+{
+	putchar( c );
+}
+#else
+/* output via uart 0, simavr echoes the transmitted lines */
+static void check_putc( char c )
+{
+	loop_until_bit_is_set(UCSR0A, UDRE0);
+	UCSR0A |= _BV(TXC0);	// clear "transmit complete" of previous char
+	UDR0 = c;
+}
+#endif
+
+static void check_puts( const char *s )
+{
+	while( *s )
+		check_putc( *s++ );
+}
+
+static void check_puts_P( const char *s )
+{
+	char c;
+	while( (c = pgm_read_byte( s++ )) )
+		check_putc( c );
+}
+
+static void check_hex( uint64_t x )
+{
+	for( int8_t i = 60; i >= 0; i -= 4 )
+		check_putc( "0123456789abcdef"[(uint8_t) (x >> i) & 15] );
+}
+
+/* call func with x, y, z and print arguments and result */
+static void check_one( const check_func_t *func, float64_t x, float64_t y, float64_t z )
+{
+	check_puts_P( func->name );
+	check_putc( ',' );
+	check_hex( x );
+	if( func->args > 1 ) {
+		check_putc( ',' );
+		check_hex( y );
+	}
+	if( func->args > 2 ) {
+		check_putc( ',' );
+		check_hex( z );
+	}
+	check_putc( ',' );
+	if( func->sfn ) {
+		check_putc( '"' );
+		check_puts( func->sfn( x ) );
+		check_putc( '"' );
+	} else
+		check_hex( func->fn( x, y, z ) );
+	check_putc( '\n' );
+}
+
+static float64_t check_value( uint8_t i )
+{
+	float64_t x;
+	memcpy_P( &x, &check_values[i], sizeof(x) );
+	return x;
+}
+
+#ifdef FP64_HOST
+int main( int argc, char **argv )
+{
+	uint32_t sweep = (argc > 1) ? strtoul( argv[1], NULL, 0 ) : CHECK_SWEEP;
+#else
+int main( void )
+{
+	uint32_t sweep = CHECK_SWEEP;
+
+	UCSR0B = _BV(TXEN0);
+#endif
+
+	check_puts_P( PSTR("function,x[,y[,z]],result\n") );
+	for( uint8_t f = 0; f < ARRAY_SIZE(check_funcs); f++ ) {
+		check_func_t func;
+		memcpy_P( &func, &check_funcs[f], sizeof(func) );
+
+		// all values of fp64check.def, all pairs of them for binary functions
+		for( uint8_t i = 0; i < CHECK_VALUES; i++ )
+			for( uint8_t j = 0; j < (func.args > 1 ? CHECK_VALUES : 1); j++ )
+				check_one( &func, check_value( i ), check_value( j ),
+					check_value( (i + j) % CHECK_VALUES ) );
+
+		// pseudo random arguments
+		check_state = CHECK_SEED;
+		for( uint32_t n = 0; n < sweep; n++ ) {
+			float64_t x = check_random();
+			float64_t y = check_random();
+			check_one( &func, x, y, check_random() );
+		}
+	}
+
+#ifdef FP64_HOST
+	return 0;
+#else
+	// simavr terminates when sleeping with interrupts disabled
+	loop_until_bit_is_set(UCSR0A, TXC0);
+	cli();
+	sleep_enable();
+	sleep_cpu();
+	for(;;)
+		;
+#endif
+}
@@ -0,0 +1,277 @@
+/* Copyright (c) 2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64isr.c
+   Interrupt stress test. "make isrcheck" builds this program against
+   libfp64-$(MCU).a and runs it within simavr for every MCU of
+   BENCH_MCUS.
+
+   The main program calls the functions of MAIN_FUNCTIONS, e.g.
+   fp64_sin, fp64_strtod and fp64_to_string, while timer 1 interrupts
+   it every 64 to 4159 cycles at pseudo random points. The interrupt
+   routine calls the functions of ISR_FUNCTIONS, e.g. fp64_cos,
+   fp64_strtod and fp64_to_string_r, so both use the same routines and
+   internal helpers at the same time. Every result is compared with the
+   one computed before with interrupts disabled, string results by a
+   hash of the string. Only the reentrant functions may be called by
+   the interrupt routine, fp64_to_string and fp64_to_decimalExp use the
+   static buffer __fp64_ftoabuf and are called by the main program only.
+
+   Output is one comma separated line per differing result:
+     main|isr,function,FAIL,index of x
+   and a final line "isr,<rounds>,<interrupts>,<failed> failed". The
+   interrupt routine only counts its failures and keeps the last one.
+   The makefile fails if any result differs.
+*/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <stdio.h>
+#include <string.h>
+#include "fp64lib.h"
+
+#define ISR_ROUNDS		10		// rounds of the main program over all values
+#define ISR_STRLEN		24		// max. length of the strings of isr_s
+
+/* arguments as bit pattern and as string for fp64_strtod */
+#define ISR_VALUES		6
+static const float64_t isr_x[ISR_VALUES] PROGMEM = {
+	0x3fe0000000000000LLU,		// 0.5
+	0xbfd5555555555555LLU,		// -1/3
+	0x400921fb54442d18LLU,		// pi
+	0x44b52d02c7e14af6LLU,		// 1e23, shortest digits by __fp64_dragon4
+	0x3f50624dd2f1a9fcLLU,		// 0.001
+	0xc05ec00000000000LLU		// -123
+};
+
+static const char isr_s[ISR_VALUES][ISR_STRLEN] PROGMEM = {
+	"0.5",
+	"-3.3333333333333331e-1",
+	"3.141592653589793",
+	"1e23",
+	"1.00000000000000002e-3",
+	"-123.456e2"
+};
+
+/* functions of the main program and of the interrupt routine, called with
+	x	argument as float64_t
+	s	argument as string
+	buf	buffer of FP64_BUFSIZE chars for the reentrant functions
+   F(f, expr)	numerical result
+   S(f, expr)	string result */
+#define MAIN_FUNCTIONS \
+	F(sin, fp64_sin(x)) \
+	F(exp, fp64_exp(x)) \
+	F(strtod, fp64_strtod(s, NULL)) \
+	S(to_string, fp64_to_string(x, 17, 5)) \
+	S(shortest, fp64_to_decimalExp(x, FP64_SHORTEST, 0, NULL))
+
+#define ISR_FUNCTIONS \
+	F(cos, fp64_cos(x)) \
+	F(log, fp64_log(x)) \
+	F(acos, fp64_acos(x)) \
+	F(strtod, fp64_strtod(s, NULL)) \
+	S(to_string_r, fp64_to_string_r(x, 15, 3, buf, FP64_BUFSIZE)) \
+	S(shortest_r, fp64_to_decimalExp_r(x, FP64_SHORTEST, 0, NULL, buf, FP64_BUFSIZE))
+
+/* index of every function */
+#define F(f, expr)	MAIN_##f,
+#define S(f, expr)	MAIN_##f,
+enum { MAIN_FUNCTIONS MAIN_COUNT };
+#undef F
+#undef S
+#define F(f, expr)	ISR_##f,
+#define S(f, expr)	ISR_##f,
+enum { ISR_FUNCTIONS ISR_COUNT };
+#undef F
+#undef S
+
+/* names of the functions */
+#define F(f, expr)	static const char main_name_##f[] PROGMEM = #f;
+#define S(f, expr)	F(f, expr)
+MAIN_FUNCTIONS
+#undef F
+#undef S
+#define F(f, expr)	static const char isr_name_##f[] PROGMEM = #f;
+#define S(f, expr)	F(f, expr)
+ISR_FUNCTIONS
+#undef F
+#undef S
+
+#define F(f, expr)	main_name_##f,
+#define S(f, expr)	F(f, expr)
+static const char * const main_names[] PROGMEM = { MAIN_FUNCTIONS };
+#undef F
+#undef S
+#define F(f, expr)	isr_name_##f,
+#define S(f, expr)	F(f, expr)
+static const char * const isr_names[] PROGMEM = { ISR_FUNCTIONS };
+#undef F
+#undef S
+
+/* results without interrupts */
+static uint64_t main_ref[ISR_VALUES][MAIN_COUNT];
+static uint64_t isr_ref[ISR_VALUES][ISR_COUNT];
+
+/* state of the interrupt routine */
+static uint8_t isr_value;				// index of next argument
+static uint16_t isr_state = 0xace1;		// pseudo random numbers
+static volatile uint16_t isr_count, isr_failed;
+static volatile uint8_t isr_fail_f, isr_fail_i;
+
+/* output via uart 0, simavr echoes the transmitted lines */
+static int isr_putchar(char c, FILE *stream)
+{
+	loop_until_bit_is_set(UCSR0A, UDRE0);
+	UCSR0A |= _BV(TXC0);	// clear "transmit complete" of previous char
+	UDR0 = c;
+	return 0;
+}
+
+static FILE isr_out = FDEV_SETUP_STREAM(isr_putchar, NULL, _FDEV_SETUP_WRITE);
+
+static uint64_t isr_hash( const char *s )
+{
+	uint64_t h = 0;
+	while( *s )
+		h = (h << 5) + (h >> 59) + (uint8_t) *s++;
+	return h;
+}
+
+/* get argument i as float64_t and as string */
+static float64_t isr_arg( uint8_t i, char *s )
+{
+	float64_t x;
+	memcpy_P( &x, &isr_x[i], sizeof(x) );
+	strcpy_P( s, isr_s[i] );
+	return x;
+}
+
+#define F(f, expr)	res[n++] = (expr);
+#define S(f, expr)	res[n++] = isr_hash( expr );
+static void main_eval( uint8_t i, uint64_t *res )
+{
+	char s[ISR_STRLEN];
+	float64_t x = isr_arg( i, s );
+	uint8_t n = 0;
+	MAIN_FUNCTIONS
+}
+
+static void isr_eval( uint8_t i, uint64_t *res )
+{
+	char s[ISR_STRLEN], buf[FP64_BUFSIZE];
+	float64_t x = isr_arg( i, s );
+	uint8_t n = 0;
+	ISR_FUNCTIONS
+}
+#undef F
+#undef S
+
+/* delay of the next interrupt, 64 to 4159 cycles, xorshift16 */
+static uint16_t isr_next( void )
+{
+	isr_state ^= isr_state << 7;
+	isr_state ^= isr_state >> 9;
+	isr_state ^= isr_state << 8;
+	return 64 + (isr_state & 4095);
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+	uint64_t res[ISR_COUNT];
+
+	isr_eval( isr_value, res );
+	for( uint8_t f = 0; f < ISR_COUNT; f++ )
+		if( res[f] != isr_ref[isr_value][f] ) {
+			isr_failed++;
+			isr_fail_f = f;
+			isr_fail_i = isr_value;
+		}
+	if( ++isr_value == ISR_VALUES )
+		isr_value = 0;
+	isr_count++;
+
+	// count the delay from the end of this routine
+	TCNT1 = 0;
+	OCR1A = isr_next();
+	TIFR1 = _BV(OCF1A);
+}
+
+static void isr_fail( const char *side, const char * const *names, uint8_t f, uint8_t i )
+{
+	fputs_P( side, &isr_out );
+	fputc( ',', &isr_out );
+	fputs_P( (const char *) pgm_read_word( &names[f] ), &isr_out );
+	fprintf_P( &isr_out, PSTR(",FAIL,%u\n"), i );
+}
+
+int main( void )
+{
+	uint64_t res[MAIN_COUNT];
+	uint16_t failed = 0;
+
+	UCSR0B = _BV(TXEN0);
+
+	for( uint8_t i = 0; i < ISR_VALUES; i++ ) {
+		main_eval( i, main_ref[i] );
+		isr_eval( i, isr_ref[i] );
+	}
+
+	// timer 1 in CTC mode without prescaler
+	OCR1A = isr_next();
+	TCCR1B = _BV(WGM12) | _BV(CS10);
+	TIMSK1 = _BV(OCIE1A);
+	sei();
+
+	for( uint8_t r = 0; r < ISR_ROUNDS; r++ )
+		for( uint8_t i = 0; i < ISR_VALUES; i++ ) {
+			main_eval( i, res );
+			for( uint8_t f = 0; f < MAIN_COUNT; f++ )
+				if( res[f] != main_ref[i][f] ) {
+					failed++;
+					isr_fail( PSTR("main"), main_names, f, i );
+				}
+		}
+
+	cli();
+	TIMSK1 = 0;
+	if( isr_failed )
+		isr_fail( PSTR("isr"), isr_names, isr_fail_f, isr_fail_i );
+	fprintf_P( &isr_out, PSTR("isr,%u,%u,%u failed\n"), ISR_ROUNDS, isr_count, failed + isr_failed );
+
+	// simavr terminates when sleeping with interrupts disabled
+	loop_until_bit_is_set(UCSR0A, TXC0);
+	sleep_enable();
+	sleep_cpu();
+	for(;;)
+		;
+}
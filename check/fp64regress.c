@@ -0,0 +1,147 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64regress.c
+   Regression tests for fixed bugs. "make regress" builds this program
+   against libfp64-$(MCU).a and runs it within simavr for every MCU of
+   BENCH_MCUS.
+
+   Every case of fp64regress.def is evaluated once and its result is
+   compared bit by bit with the expected one. Output is one comma
+   separated line per case:
+     name,ok
+     name,FAIL,result,expected
+   and a final line "regress,<cases>,<failed> failed". The makefile
+   fails if any case fails.
+*/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <stdio.h>
+#include <string.h>
+#include "fp64lib.h"
+
+/* second results of functions with a pointer argument, cases of
+   fp64regress.def may read them with the comma operator */
+float64_t regress_int;
+int regress_exp;
+unsigned long regress_n;
+char *regress_end;
+
+/* buffer for the reentrant string conversions */
+char regress_buf[FP64_BUFSIZE];
+
+/* float arguments and results as bit pattern */
+static float regress_float( uint32_t u )
+{
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+static uint32_t regress_fbits( float f )
+{
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+/* output via uart 0, simavr echoes the transmitted lines */
+static int regress_putchar(char c, FILE *stream)
+{
+	loop_until_bit_is_set(UCSR0A, UDRE0);
+	UCSR0A |= _BV(TXC0);	// clear "transmit complete" of previous char
+	UDR0 = c;
+	return 0;
+}
+
+static FILE regress_out = FDEV_SETUP_STREAM(regress_putchar, NULL, _FDEV_SETUP_WRITE);
+
+static uint16_t regress_cases, regress_failed;
+
+static void regress_hex( uint64_t x )
+{
+	fprintf_P(&regress_out, PSTR("%08lx%08lx"), (uint32_t) (x >> 32), (uint32_t) x);
+}
+
+/* compare numerical result, integer results are sign extended to 64 bit */
+static void regress_num( const char *name, uint64_t res, uint64_t expected )
+{
+	regress_cases++;
+	fputs_P(name, &regress_out);
+	if( res == expected ) {
+		fputs_P(PSTR(",ok\n"), &regress_out);
+		return;
+	}
+	regress_failed++;
+	fputs_P(PSTR(",FAIL,"), &regress_out);
+	regress_hex(res);
+	fputc(',', &regress_out);
+	regress_hex(expected);
+	fputc('\n', &regress_out);
+}
+
+/* compare string result */
+static void regress_str( const char *name, const char *res, const char *expected )
+{
+	regress_cases++;
+	fputs_P(name, &regress_out);
+	if( strcmp_P(res, expected) == 0 ) {
+		fputs_P(PSTR(",ok\n"), &regress_out);
+		return;
+	}
+	regress_failed++;
+	fprintf_P(&regress_out, PSTR(",FAIL,\"%s\",\"%S\"\n"), res, expected);
+}
+
+int main( void )
+{
+	UCSR0B = _BV(TXEN0);
+
+	/* R(name, expr, expected)	numerical result as bit pattern
+	   RS(name, expr, expected)	string result */
+#define R(name, expr, expected)		regress_num(PSTR(#name), (uint64_t) (expr), expected##LLU);
+#define RS(name, expr, expected)	regress_str(PSTR(#name), (expr), PSTR(expected));
+#include "fp64regress.def"
+#undef R
+#undef RS
+
+	fprintf_P(&regress_out, PSTR("regress,%u,%u failed\n"), regress_cases, regress_failed);
+
+	// simavr terminates when sleeping with interrupts disabled
+	loop_until_bit_is_set(UCSR0A, TXC0);
+	cli();
+	sleep_enable();
+	sleep_cpu();
+	for(;;)
+		;
+}
@@ -67,18 +67,18 @@ float64_t fp64_gamma1(float64_t zpar) {
 // gamma function (lanczos approximation) 
 // sources: https://en.wikipedia.org/wiki/Lanczos_approximation
 //          https://rosettacode.org/wiki/Gamma_function
-// Using Double wrapper class
+// Using Double wrapper class, the coefficients are converted by the compiler
 Double Dbl_gamma1(Double zpar) {
   const static Double par[9] = {
-    Double("0.99999999999980993"),
-    Double("676.5203681218851"),
-    Double("-1259.1392167224028"),
-    Double("771.32342877765313"),
-    Double("-176.61502916214059"),
-    Double("12.507343278686905"),
-    Double("-0.13857109526572012"),
-    Double("9.9843695780195716E-6"),
-    Double("1.5056327351493116E-7")
+    "0.99999999999980993"_fp64,
+    "676.5203681218851"_fp64,
+    "-1259.1392167224028"_fp64,
+    "771.32342877765313"_fp64,
+    "-176.61502916214059"_fp64,
+    "12.507343278686905"_fp64,
+    "-0.13857109526572012"_fp64,
+    "9.9843695780195716E-6"_fp64,
+    "1.5056327351493116E-7"_fp64
   };
 
   Double tt = zpar + Double(6.5);
@@ -94,6 +94,25 @@ Double Dbl_gamma1(Double zpar) {
   return res;
 }
 
+// polynom c[0]*x^(n-1) + ... + c[n-1] by Horner's scheme
+// with the wrapper class, p*x + c[i] is computed by one call to fp64_fma,
+// that rounds only once and is faster than fp64_mul followed by fp64_add
+// (degree 10: 7692 instead of 9287 cycles in the library calls, but
+// fp64_fma needs 1432 bytes of flash more, measured on an ATmega328P)
+float64_t fp64_horner(const float64_t c[], byte n, float64_t x) {
+  float64_t p = c[0];
+  for( byte i = 1; i < n; i++ )
+    p = fp64_add( fp64_mul( p, x ), c[i] );
+  return p;
+}
+
+Double Dbl_horner(const Double c[], byte n, const Double &x) {
+  Double p = c[0];
+  for( byte i = 1; i < n; i++ )
+    p = p*x + c[i];
+  return p;
+}
+
 void setup() {
 	Serial.begin(57600);
 	
@@ -133,6 +152,33 @@ void setup() {
 		Serial.print( "gamma(" ); Serial.print(x.toString(4)); Serial.print(")=");
 		Serial.println( res.toString(13) );
 	}
+
+	Serial.println();
+	Serial.println( "exp(0.5) by Taylor series of degree 10, 100 evaluations" );
+	float64_t c[11];
+	Double dc[11];
+	float64_t f = float64_NUMBER_ONE;
+	for( int i = 10; i >= 0; i-- ) {
+		c[i] = f;			// c[10] = 1/0!, ..., c[0] = 1/10!
+		dc[i] = Double( f );
+		f = fp64_div( f, fp64_int16_to_float64(11-i) );
+	}
+	float64_t xf = fp64_atof( "0.5" );
+	Double xd = Double( "0.5" );
+	float64_t resf;
+	Double resd;
+	unsigned long t = micros();
+	for( int i = 0; i < 100; i++ )
+		resf = fp64_horner( c, 11, xf );
+	t = micros() - t;
+	Serial.print( "fp64_mul and fp64_add: " ); Serial.print( fp64_to_string(resf, 17, 15) );
+	Serial.print( " in " ); Serial.print( t ); Serial.println( "us" );
+	t = micros();
+	for( int i = 0; i < 100; i++ )
+		resd = Dbl_horner( dc, 11, xd );
+	t = micros() - t;
+	Serial.print( "Double, with fp64_fma: " ); Serial.print( resd.toString() );
+	Serial.print( " in " ); Serial.print( t ); Serial.println( "us" );
 }
 
 void loop() {
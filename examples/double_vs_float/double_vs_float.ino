@@ -33,7 +33,7 @@
  *
  */
  
-#include <fp64lib.h>
+#include <Double.h>
 
 void setup() {
 	Serial.begin(57600);
@@ -120,6 +120,20 @@ void setup() {
 	Serial.print("float64_t c = "); Serial.print( fp64_to_string(c,17,15) );  Serial.print( " diff = " ); Serial.println( fp64_to_string(fp64_sub(c,cc),17,15) );
 	Serial.println();
 	
+	// Double computes a*b-1 by fp64_fma: 946 cycles instead of 818 for
+	// fp64_mul and fp64_sub, and 1432 bytes more flash, but exact
+	Serial.println( "Now a*b-1 with a = 1+2^-30, b = 1-2^-30\nRes should be -2^-60 = -8.673617379884035e-19" );
+	a = 1.000000000931322574615478515625;
+	aa = 0.999999999068677425384521484375;
+	c = fp64_atof( "1.000000000931322574615478515625" );
+	cc = fp64_atof( "0.999999999068677425384521484375" );
+	Double da = Double( "1.000000000931322574615478515625" );
+	Double db = Double( "0.999999999068677425384521484375" );
+	Double dc = da*db - Double(1);	// computed by fp64_fma, rounded only once
+	Serial.print("    float a = "); Serial.println( a*aa-1.0, 15 );
+	Serial.print("float64_t c = "); Serial.println( fp64_to_string(fp64_sub(fp64_mul(c,cc),float64_NUMBER_ONE),17,15) );
+	Serial.print("   Double c = "); Serial.println( dc.toString() );
+	Serial.println();
 }
 
 void loop() {
@@ -29,24 +29,31 @@ void setup() {
   Serial.begin(57600);
 }
 
-char *fixedLength( char *s, float64_t x ) {
-    // return a string always with the same length, including trailing zeros
-    char *t = fp64_to_string( x, 17, 15 );
-    sprintf( s, "%s%s00000000000000000", t[0] == '-' ? " " : "  ", t );
-    s[18] = '\0';
-    return s;
+void toSerial( char c, void *ctx ) {
+    // sink for fp64_to_string_sink, ctx is the Print object to use
+    static_cast<Print*>(ctx)->write( c );
+}
+
+void printFixedLength( float64_t x ) {
+    // print x always with the same length, including trailing zeros
+    uint8_t n = 1;
+    Serial.print( " " );
+    if( !fp64_signbit( x ) ) {
+      Serial.print( " " );
+      n++;
+    }
+    n += fp64_to_string_sink( x, 18-n, 15, toSerial, static_cast<Print*>(&Serial) );
+    while( n++ < 18 )
+      Serial.print( "0" );
 }
 
 void printLine( float nf, float64_t x, float xf, const char* s, bool usePi ) {
-    char buf[40];
-  
     float64_t delta = fp64_sub( x, usePi ? pi : pi4 );
     float deltaf = xf - (usePi ? pif : pi4f );
     
-    char *t = fp64_to_string( x, 17, 15 );
     Serial.print( nf, 0 ); Serial.print( s ); Serial.print( ":" );
-    Serial.print( fixedLength( buf, x ) ); 
-    Serial.print( fixedLength( buf, delta ) ); 
+    printFixedLength( x ); 
+    printFixedLength( delta ); 
     Serial.print( "\t" );
 
     Serial.print( " " ); Serial.print( xf, 7 );
@@ -171,6 +171,7 @@ float64_t fp64_cosh(float64_t x);
 float64_t fp64_cotan(float64_t x);
 float64_t fp64_exp(float64_t x);
 float64_t fp64_exp10(float64_t x);
+float64_t fp64_expm1(float64_t x);				// [all added with C99]
 float64_t fp64_fabs(float64_t x);
 //float64_t fabs(long float64_t x);
 float64_t fp64_fdim(float64_t x, float64_t y);
@@ -181,21 +182,27 @@ float64_t fp64_fmin(float64_t x, float64_t y); // [all added with C99]
 float64_t fp64_fmod(float64_t x, float64_t y);
 float64_t fp64_frexp(float64_t x, int *pexp);
 float64_t fp64_hypot(float64_t x, float64_t y); // [all added with C99]
+float64_t fp64_hypot3(float64_t x, float64_t y, float64_t z);
 int fp64_ilogb(float64_t x); 					// [all added with C99]
 float64_t fp64_ldexp(float64_t x, int ex);
 long fp64_lrint(float64_t x);
 long fp64_lround(float64_t x);
 float64_t fp64_log(float64_t x);
 float64_t fp64_log10(float64_t x);
+float64_t fp64_log1p(float64_t x);				// [all added with C99]
 float64_t fp64_log2(float64_t x);				// [all added with C99]
 float64_t fp64_logb(float64_t x); 				// [all added with C99]
 float64_t fp64_modf(float64_t x, float64_t *pint);
 float64_t fp64_pow(float64_t x, float64_t y);
+float64_t fp64_powi(float64_t x, int n);
 float64_t fp64_round(float64_t x);
+float64_t fp64_rsqrt(float64_t x);
 float64_t fp64_scalbln(float64_t x, long n); 	// [all added with C99]
 float64_t fp64_scalbn(float64_t x, int n); 	// [all added with C99]
 float64_t fp64_sin(float64_t x);
+void fp64_sincos(float64_t x, float64_t *s, float64_t *c);
 float64_t fp64_sinh(float64_t x);
+void fp64_sinhcosh(float64_t x, float64_t *s, float64_t *c);
 float64_t fp64_square( float64_t x );
 float64_t fp64_sqrt(float64_t x);
 float64_t fp64_tan(float64_t x);
@@ -30,7 +30,7 @@
 
 /* Interprocedure convensions. In separate file: for math library
    developers.	*/
-#if (!defined(__AVR_ATmega328P__) || defined(__AVR_TINY__) || !defined(__AVR_ENHANCED__)) && !defined(ARDUINO_AVR_MEGA2560) &&!defined(__AVR_MEGA__)
+#if (!defined(__AVR_ATmega328P__) || defined(__AVR_TINY__) || !defined(__AVR_ENHANCED__)) && !defined(ARDUINO_AVR_MEGA2560) &&!defined(__AVR_MEGA__) && !defined(FP64_HOST)
 #error fp64lib is created and tested only for Atmel AVR 328p microprocessors like Arduino UNO or Nano
 #endif
    
@@ -45,6 +45,9 @@
 #ifndef EIND
 #define EIND 0x3c
 #endif
+#define RETSIZE	3		/* size of return address on stack */
+#else
+#define RETSIZE	2
 #endif
 
 /*
@@ -65,6 +68,14 @@ Registers
 
 #define MAX_SIGNIFICAND		17
 #define	MAX_EXPONENT		3
+// size of buffer for string conversion: sign, leading digit, '.', trailing digits,
+// '\0' for separated significand, 'E', sign of exponent, exponent and terminating '\0'
+#define FP64_BUFSIZE		(MAX_SIGNIFICAND+MAX_EXPONENT+6)
+
+// range of cached powers of ten 10^k used by the conversion algorithms
+// k = FP64_CACHED_KMIN + 8*i, see __fp64_cachedpow
+#define FP64_CACHED_KMIN	-348
+#define FP64_CACHED_KMAX	316
 
 #define FP_ILOGB0		(0x8800)
 #define FP_ILOGBNAN		(0x87ff)
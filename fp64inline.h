@@ -0,0 +1,168 @@
+/* Copyright (c) 2019-2025  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE. */
+/* $Id$ */
+
+/* Inline versions of the simple fp64lib functions
+   fp64_abs, fp64_neg, fp64_signbit, fp64_isnan, fp64_isinf, fp64_isfinite,
+   fp64_classify, fp64_compare, fp64_fmin and fp64_fmax
+   working directly on the bit pattern of float64_t.
+
+   Usage: Do "#include <fp64inline.h>" instead of (or after) "#include <fp64lib.h>".
+   Calls like fp64_abs(x) are then replaced by the inline versions, so the
+   compiler can combine them with the surrounding code, e.g. a test of
+   fp64_signbit(x) becomes a test of a single bit instead of a call
+   that passes all 8 bytes of x in registers.
+   To use them with the Double wrapper class, include fp64inline.h before
+   Double.h. The library functions can still be called by putting their
+   name in parentheses, e.g. (fp64_compare)(a, b), or via a pointer.
+
+   The results are the same as those of the library functions, including
+   NaN, Inf, subnormal numbers and -0.0:
+   - fp64_compare returns 1 if any argument is NaN, and -0.0 == +0.0
+   - fp64_fmin and fp64_fmax return the other argument if one is NaN,
+     and treat -0.0 as less than +0.0
+   Each use of these functions is expanded in place, so code that calls
+   them in many places may get larger.
+*/
+
+#ifndef fp64inline_h_included
+#define fp64inline_h_included
+
+#include "fp64lib.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif 
+
+// access to the upper bytes of float64_t without 64 bit shifts
+typedef union {
+	float64_t f;
+	uint16_t w[4];	// w[3] = sign, exponent and upper 4 bits of mantissa
+	uint8_t b[8];	// b[7] = sign and upper 7 bits of exponent
+} __fp64_inline_t;
+
+static inline float64_t fp64_abs_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	u.b[7] &= 0x7f;
+	return u.f;
+}
+
+static inline float64_t fp64_neg_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	u.b[7] ^= 0x80;
+	return u.f;
+}
+
+static inline int fp64_signbit_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	return u.b[7] >> 7;
+}
+
+// mantissa != 0, exponent is not tested
+static inline uint8_t __fp64_inline_mant( __fp64_inline_t u ) {
+	return ((u.w[3] & 0x000f) | u.w[2] | u.w[1] | u.w[0]) != 0;
+}
+
+static inline int fp64_isnan_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	return (u.w[3] & 0x7ff0) == 0x7ff0 && __fp64_inline_mant( u );
+}
+
+static inline int fp64_isinf_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	if( (u.w[3] & 0x7ff0) != 0x7ff0 || __fp64_inline_mant( u ) )
+		return 0;
+	return u.b[7] & 0x80 ? -1 : 1;
+}
+
+static inline int fp64_isfinite_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	return (u.w[3] & 0x7ff0) != 0x7ff0;
+}
+
+// 0 for 0, 1 for NaN, 2 for Inf, 3 for subnormal and 4 for normal numbers
+static inline int fp64_classify_inline( float64_t x ) {
+	__fp64_inline_t u = { x };
+	uint16_t e = u.w[3] & 0x7ff0;
+	if( e == 0x7ff0 )
+		return __fp64_inline_mant( u ) ? 1 : 2;
+	if( e == 0 )
+		return __fp64_inline_mant( u ) ? 3 : 0;
+	return 4;
+}
+
+// maps x to an unsigned number in the same order as x, -0.0 < +0.0
+static inline uint64_t __fp64_inline_key( float64_t x ) {
+	__fp64_inline_t u = { x };
+	if( u.b[7] & 0x80 )
+		return ~x;
+	u.b[7] |= 0x80;
+	return u.f;
+}
+
+static inline int8_t fp64_compare_inline( float64_t a, float64_t b ) {
+	if( fp64_isnan_inline( a ) || fp64_isnan_inline( b ) )
+		return 1;
+	if( fp64_abs_inline( a ) == 0 && fp64_abs_inline( b ) == 0 )
+		return 0;		// -0.0 == +0.0
+	uint64_t ka = __fp64_inline_key( a ), kb = __fp64_inline_key( b );
+	return ka < kb ? -1 : ka != kb;
+}
+
+static inline float64_t fp64_fmin_inline( float64_t a, float64_t b ) {
+	if( fp64_isnan_inline( a ) )
+		return b;
+	if( fp64_isnan_inline( b ) )
+		return a;
+	return __fp64_inline_key( a ) <= __fp64_inline_key( b ) ? a : b;
+}
+
+static inline float64_t fp64_fmax_inline( float64_t a, float64_t b ) {
+	if( fp64_isnan_inline( a ) )
+		return b;
+	if( fp64_isnan_inline( b ) )
+		return a;
+	return __fp64_inline_key( a ) >= __fp64_inline_key( b ) ? a : b;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#define fp64_abs(x)			fp64_abs_inline(x)
+#define fp64_neg(x)			fp64_neg_inline(x)
+#define fp64_signbit(x)		fp64_signbit_inline(x)
+#define fp64_isnan(x)		fp64_isnan_inline(x)
+#define fp64_isinf(x)		fp64_isinf_inline(x)
+#define fp64_isfinite(x)	fp64_isfinite_inline(x)
+#define fp64_classify(x)	fp64_classify_inline(x)
+#define fp64_compare(a,b)	fp64_compare_inline(a,b)
+#define fp64_fmin(a,b)		fp64_fmin_inline(a,b)
+#define fp64_fmax(a,b)		fp64_fmax_inline(a,b)
+
+#endif
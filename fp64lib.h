@@ -56,6 +56,24 @@
    with const attribute as "do not examine any values except their
    arguments, and have no effects except the return value", for better
    optimization by GCC.
+
+   fp64lib can also serve as backend of the native double type of
+   avr-gcc with -mdouble=64: it provides the libgcc helpers for
+   arithmetic (__adddf3 ... __divdf3, __negdf2), comparison (__cmpdf2,
+   __eqdf2 ... __gtdf2, __unorddf2) and conversion (__fixdfsi ...
+   __floatundidf, __extendsfdf2, __truncdfsf2, __powidf2) and the libm
+   functions as __sin etc. If the library itself is compiled with
+   -mdouble=64, the plain libm names (sin, fabs, ...) are defined as
+   weak aliases, too. See "make dblbench" in the makefile.
+
+   For tests and simulations on a PC, "make libfp64host.a" builds a
+   portable C version of the arithmetic, rounding and conversion
+   functions with the results of the AVR library bit by bit, compile
+   with -DFP64_HOST to use it. "make crosscheck" compares both.
+   The host build does not include the transcendental functions,
+   fp64_pow, fp64_powi, fp64_hypot, fp64_cbrt, fp64_rsqrt, fp64_logb,
+   fp64_strtod, fp64_atof, fp64x_*, fp64_poly* and the vector functions,
+   their prototypes are still declared but have no definition.
 */
 
 #ifndef fp64lib_h_included
@@ -76,6 +94,36 @@ extern "C"{
 typedef uint64_t float64_t; /* IEEE 754 double precision floating point number */
 typedef float    float32_t; /* IEEE 754 single precision floating point number */
 
+/* unpacked extended precision number, as used internally by fp64lib
+   significand of 56 bits (53 bits + 3 guard bits), sign and a 16 bit
+   exponent. Operations on fp64x_t do not round, rounding to float64_t
+   is done only once by fp64x_store. */
+typedef struct {
+	uint8_t m[7];	/* significand, leading 1 in bit 7 of m[6] */
+	uint8_t s;		/* sign in bit 7 */
+	int16_t e;		/* exponent, base 1023, 0x7ff for Inf/NaN */
+} fp64x_t;
+
+/* coefficient of a polynom for fp64_poly & co. in program memory, in the
+   unpacked format used by fp64lib: sign (0x00 or 0x80), 56 bit significand
+   with leading 1 bit and 16 bit exponent (base 1023), most significant byte
+   first. 0.0 is stored as 10 zero bytes. */
+typedef struct {
+	uint8_t b[10];
+} fp64_coeff_t;
+
+/* FP64_COEFF(x) converts the bit pattern x of a float64_t into an
+   initializer of fp64_coeff_t, e.g.
+   const fp64_coeff_t c[] PROGMEM = { FP64_COEFF(0x3fe0000000000000LLU), ... };
+   subnormal numbers are converted to 0 */
+#define __FP64_CM(x)	((((uint64_t)(x)) & 0x7ff0000000000000LLU) ? \
+						 ((((uint64_t)(x)) & 0x000fffffffffffffLLU) | 0x0010000000000000LLU) << 3 : 0)
+#define __FP64_CB(x,n)	((uint8_t)(__FP64_CM(x) >> (8*(n))))
+#define FP64_COEFF(x)	{ { (uint8_t)((((uint64_t)(x)) >> 56) & 0x80), \
+						__FP64_CB(x,6), __FP64_CB(x,5), __FP64_CB(x,4), __FP64_CB(x,3), \
+						__FP64_CB(x,2), __FP64_CB(x,1), __FP64_CB(x,0), \
+						(uint8_t)((((uint64_t)(x)) >> 60) & 0x07), (uint8_t)(((uint64_t)(x)) >> 52) } }
+
 #define float64_EULER_E 							((float64_t)0x4005bf0a8b145769LLU)	// 2.7182818284590452
 #define float64_NUMBER_PI 							((float64_t)0x400921fb54442d18LLU)  // 3.1415926535897932
 #define float64_NUMBER_PIO2							((float64_t)0x3ff921fb54442d18LLU)  // 3.1415926535897932/2
@@ -105,7 +153,7 @@ float64_t fp64_sub( float64_t a, float64_t b ) __ATTR_CONST__;
 float64_t fp64_mul( float64_t a, float64_t b ) __ATTR_CONST__;
 float64_t fp64_div( float64_t a, float64_t b ) __ATTR_CONST__;
 float64_t fp64_fmod( float64_t a, float64_t b ) __ATTR_CONST__;
-float64_t fp64_fmodn( float64_t a, float64_t b, unsigned long *np ) __ATTR_CONST__;
+float64_t fp64_fmodn( float64_t a, float64_t b, unsigned long *np );
 // float64_t fp64_remquo( float64_t a, float64_t b, unsigned long *np ) __ATTR_CONST__;
 
 // isXXX  & compare functions
@@ -123,6 +171,7 @@ float64_t fp64_neg( float64_t x ) __ATTR_CONST__;
 float64_t fp64_abs( float64_t x ) __ATTR_CONST__;
 float64_t fp64_inverse( float64_t x ) __ATTR_CONST__;
 float64_t fp64_sqrt( float64_t x ) __ATTR_CONST__;
+float64_t fp64_rsqrt( float64_t x ) __ATTR_CONST__;
 float64_t fp64_square( float64_t x ) __ATTR_CONST__;
 float64_t fp64_trunc( float64_t x ) __ATTR_CONST__;
 float64_t fp64_cut_noninteger_fraction( float64_t x ) __ATTR_CONST__; //alias to fp64_trunc
@@ -137,6 +186,8 @@ int fp64_ilogb(float64_t x) __ATTR_CONST__; 						// [all added with C99]
 // trigonometric functions
 float64_t fp64_sin( float64_t x ) __ATTR_CONST__;
 float64_t fp64_cos( float64_t x ) __ATTR_CONST__;
+// fp64_sincos computes both results at once, they may differ by 1 ulp from fp64_sin and fp64_cos
+void fp64_sincos( float64_t x, float64_t *s, float64_t *c );		// *s = sin(x), *c = cos(x)
 float64_t fp64_tan( float64_t x ) __ATTR_CONST__;
 float64_t fp64_cotan( float64_t x ) __ATTR_CONST__;
 float64_t fp64_atan( float64_t x ) __ATTR_CONST__;
@@ -144,6 +195,8 @@ float64_t fp64_asin( float64_t x ) __ATTR_CONST__;
 float64_t fp64_acos( float64_t x ) __ATTR_CONST__;
 float64_t fp64_log( float64_t x ) __ATTR_CONST__;
 float64_t fp64_exp( float64_t x ) __ATTR_CONST__;
+float64_t fp64_expm1( float64_t x ) __ATTR_CONST__;
+float64_t fp64_log1p( float64_t x ) __ATTR_CONST__;
 float64_t fp64_log10( float64_t x ) __ATTR_CONST__;
 float64_t fp64_log2( float64_t x ) __ATTR_CONST__;
 float64_t fp64_logb( float64_t x ) __ATTR_CONST__;
@@ -153,24 +206,60 @@ float64_t fp64_pow10( float64_t x ) __ATTR_CONST__;
 float64_t fp64_sinh( float64_t x ) __ATTR_CONST__;
 float64_t fp64_cosh( float64_t x ) __ATTR_CONST__;
 float64_t fp64_tanh( float64_t x ) __ATTR_CONST__;
+// fp64_sinhcosh computes both results at once, they may differ by 1 ulp from fp64_sinh and fp64_cosh
+void fp64_sinhcosh( float64_t x, float64_t *s, float64_t *c );	// *s = sinh(x), *c = cosh(x)
 float64_t fp64_asinh( float64_t x ) __ATTR_CONST__;
 float64_t fp64_acosh( float64_t x ) __ATTR_CONST__;
 float64_t fp64_atanh( float64_t x ) __ATTR_CONST__;
 
+// faster variants with shorter polynoms and a relative error below 5E-11 (about 10 significant digits)
+float64_t fp64_sin_fast( float64_t x ) __ATTR_CONST__;		// error < 2.2E-11 = 1.9E5 ulp
+float64_t fp64_cos_fast( float64_t x ) __ATTR_CONST__;		// error < 2.2E-11 = 1.9E5 ulp
+float64_t fp64_atan_fast( float64_t x ) __ATTR_CONST__;	// error < 4.9E-11 = 4.4E5 ulp
+float64_t fp64_exp_fast( float64_t x ) __ATTR_CONST__;		// error < 1.4E-11 = 1.2E5 ulp
+float64_t fp64_log_fast( float64_t x ) __ATTR_CONST__;		// error < 4.3E-12 = 3.8E4 ulp
+
 // functions with 2 arguments
-float64_t fp64_fmodx_pi2( float64_t x, unsigned long *np ) __ATTR_CONST__;
+float64_t fp64_fmodx_pi2( float64_t x, unsigned long *np );
 float64_t fp64_ldexp( float64_t x, int exp ) __ATTR_CONST__;
 float64_t fp64_scalbln(float64_t x, long ex) __ATTR_CONST__; 	// [all added with C99]
 float64_t fp64_scalbn(float64_t x, int ex) __ATTR_CONST__; 		// [all added with C99], alias to ldexp
-float64_t fp64_frexp( float64_t x, int *pexp ) __ATTR_CONST__;
+float64_t fp64_frexp( float64_t x, int *pexp );
 float64_t fp64_fdim( float64_t A, float64_t B ) __ATTR_CONST__;
 float64_t fp64_pow( float64_t x, float64_t y ) __ATTR_CONST__;
+float64_t fp64_powi( float64_t x, int n ) __ATTR_CONST__;
 float64_t fp64_hypot( float64_t x, float64_t y ) __ATTR_CONST__;
 float64_t fp64_atan2( float64_t y, float64_t x ) __ATTR_CONST__;
 float64_t fp64_modf (float64_t x, float64_t *iptr);
 
 // functions with 3 arguments
 float64_t fp64_fma (float64_t A, float64_t B, float64_t C) __ATTR_CONST__;
+float64_t fp64_hypot3( float64_t x, float64_t y, float64_t z ) __ATTR_CONST__;
+
+// batch functions on arrays of n elements
+// fp64_axpy and fp64_dot add the product as fp64_mul computes it with 72 bits, truncated
+// and not rounded, and round only after the addition, so their results may differ from a
+// loop of fp64_mul and fp64_add, and as the product is not exact, also from fp64_fma
+void fp64_add_n( float64_t *r, const float64_t *a, const float64_t *b, uint16_t n );	// r[i] = a[i] + b[i]
+void fp64_mul_n( float64_t *r, const float64_t *a, const float64_t *b, uint16_t n );	// r[i] = a[i] * b[i]
+void fp64_scale_n( float64_t *r, const float64_t *a, float64_t s, uint16_t n );		// r[i] = a[i] * s
+void fp64_axpy( float64_t *y, const float64_t *x, float64_t a, uint16_t n );			// y[i] += a * x[i]
+float64_t fp64_dot( const float64_t *a, const float64_t *b, uint16_t n );				// sum of a[i] * b[i]
+
+// extended precision functions on unpacked numbers
+void fp64x_load( fp64x_t *r, float64_t x );						// *r = x
+float64_t fp64x_store( const fp64x_t *a );						// a rounded to float64_t
+void fp64x_add( fp64x_t *r, const fp64x_t *a, const fp64x_t *b );	// *r = a + b
+void fp64x_sub( fp64x_t *r, const fp64x_t *a, const fp64x_t *b );	// *r = a - b
+void fp64x_mul( fp64x_t *r, const fp64x_t *a, const fp64x_t *b );	// *r = a * b
+void fp64x_div( fp64x_t *r, const fp64x_t *a, const fp64x_t *b );	// *r = a / b
+void fp64x_sqrt( fp64x_t *r, const fp64x_t *a );					// *r = sqrt(a)
+
+// polynoms with coefficients c[0] (highest power) ... c[n] in program memory
+float64_t fp64_poly( float64_t x, const fp64_coeff_t *c, uint8_t n );		// c[0]*x^n + ... + c[n]
+float64_t fp64_polyeven( float64_t x, const fp64_coeff_t *c, uint8_t n );	// c[0]*x^2n + ... + c[n]
+float64_t fp64_polyodd( float64_t x, const fp64_coeff_t *c, uint8_t n );	// c[0]*x^(2n+1) + ... + c[n]*x
+float64_t fp64_ratpoly( float64_t x, const fp64_coeff_t *p, uint8_t np, const fp64_coeff_t *q, uint8_t nq );	// P(x)/Q(x)
 
 // conversion functions
 float64_t fp64_int64_to_float64( long long x ) __ATTR_CONST__;	// (signed) long long to float64_t
@@ -197,8 +286,25 @@ float64_t fp64_sd( float x ) __ATTR_CONST__;					// float to float64_t
 float fp64_ds( float64_t x ) __ATTR_CONST__;					// float64_t to float
 
 // to and from string
+// maxDigits = FP64_SHORTEST gives the shortest significand that converts back to x
+// it needs up to 480 bytes of stack, at most 120 bytes for 1e-20 < |x| < 1e20
+#define FP64_SHORTEST	0
 char *fp64_to_decimalExp( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10 );
 char *fp64_to_string( float64_t x, uint8_t max_nr_chars, uint8_t max_leading_mantisse_zeros );
+char *fp64_etoa( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10 );
+
+// reentrant versions, result is stored in buf instead of a static scratch area
+// size is the size of buf including the terminating '\0', a buf of FP64_BUFSIZE chars
+// is large enough for all results. A number is never truncated: fp64_to_string_r limits
+// max_nr_chars to size-1, fp64_to_decimalExp_r and fp64_etoa_r reduce maxDigits until the
+// result fits, with expSep only the significand has to fit, the exponent is stored behind
+// if there is room left, else it is "". If not even the shortest form fits, buf is "".
+// For size 0 nothing is stored and NULL is returned.
+char *fp64_to_decimalExp_r( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10, char *buf, uint8_t size );
+char *fp64_to_string_r( float64_t x, uint8_t max_nr_chars, uint8_t max_leading_mantisse_zeros, char *buf, uint8_t size );
+char *fp64_etoa_r( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10, char *buf, uint8_t size );
+// streaming version, every char of the result is passed to sink, returns # of chars
+uint8_t fp64_to_string_sink( float64_t x, uint8_t max_nr_chars, uint8_t max_leading_mantisse_zeros, void (*sink)( char c, void *ctx ), void *ctx );
 float64_t fp64_atof( char *str );
 float64_t fp64_strtod( char *str, char **endptr );
 
@@ -206,6 +312,253 @@ float64_t fp64_strtod( char *str, char **endptr );
 
 #ifdef __cplusplus
 } // extern "C"
+
+#if __cplusplus >= 201103L && __SIZEOF_DOUBLE__ == 8
+/* compile time conversion of double constants, only where double has 64 bits
+   (host compilers, avr-gcc with -mdouble=64), e.g.
+   const fp64_coeff_t c[] PROGMEM = { fp64_coeff(0.5), fp64_coeff(-1.25) };
+   -0.0 is converted to +0.0 */
+constexpr double __fp64_cpow2( int e ) {	// 2^e
+	return e >= 64 ? __fp64_cpow2(e - 64) * 18446744073709551616.0
+		: e <= -64 ? __fp64_cpow2(e + 64) / 18446744073709551616.0
+		: e > 0 ? __fp64_cpow2(e - 1) * 2.0
+		: e < 0 ? __fp64_cpow2(e + 1) / 2.0 : 1.0;
+}
+
+constexpr int __fp64_cilogb( double a, int e ) {	// e + floor(log2(a)) for a > 0
+	return a >= 18446744073709551616.0 ? __fp64_cilogb(a / 18446744073709551616.0, e + 64)
+		: a < 1.0 / 18446744073709551616.0 ? __fp64_cilogb(a * 18446744073709551616.0, e - 64)
+		: a >= 2.0 ? __fp64_cilogb(a / 2.0, e + 1)
+		: a < 1.0 ? __fp64_cilogb(a * 2.0, e - 1) : e;
+}
+
+constexpr float64_t __fp64_cbits( double a, int e ) {	// bit pattern of a > 0 with exponent e
+	return e < -1022 ? (float64_t)(a * __fp64_cpow2(1022) * 4503599627370496.0)
+		: ((float64_t)(e + 1023) << 52)
+		  | ((float64_t)(a * __fp64_cpow2(-e) * 4503599627370496.0) & 0x000fffffffffffffLLU);
+}
+
+constexpr float64_t fp64_bits( double d ) {	// bit pattern of d as float64_t
+	return d != d ? float64_ONE_POSSIBLE_NAN_REPRESENTATION
+		: d < 0 ? float64_NUMBER_MINUS_ZERO | fp64_bits(-d)
+		: d == 0 ? float64_NUMBER_PLUS_ZERO
+		: d > 1.7976931348623157e308 ? float64_PLUS_INFINITY
+		: __fp64_cbits(d, __fp64_cilogb(d, 0));
+}
+
+constexpr fp64_coeff_t fp64_coeff_bits( float64_t x ) {	// coefficient from a bit pattern
+	return FP64_COEFF(x);
+}
+
+constexpr fp64_coeff_t fp64_coeff( double d ) {	// coefficient from a double
+	return fp64_coeff_bits(fp64_bits(d));
+}
+#endif
+
+#if __cplusplus >= 201103L
+/* compile time conversion of decimal text into float64_t, independent of
+   the size of double, e.g.
+   const float64_t pi = "3.14159265358979323846"_fp64;
+   const float64_t c[] PROGMEM = { "0.1"_fp64, FP64_CONST("-2.5e-3") };
+   const Double x = "1e-300"_fp64;
+   Text is [+|-]digits[.digits][e|E[+|-]digits] and is rounded to nearest,
+   ties to even. The first 37 significant digits are used, further digits
+   only break ties. The result is correctly rounded, unless the text is
+   within about 2^-120 (relative) of the midpoint between two float64_t.
+   Invalid text is reported by the compiler as a call to the undefined,
+   non constexpr function __fp64_invalid_literal.
+   FP64_CONST forces evaluation at compile time, also where a constant
+   expression is not required, e.g. in function arguments. */
+float64_t __fp64_invalid_literal( void );
+
+struct __fp64_c128 { uint64_t h, l; };			// 128 bit integer
+struct __fp64_c256 { __fp64_c128 h, l; };		// 256 bit integer
+struct __fp64_cfp { __fp64_c128 m; int e; bool st; };	// m * 2^(e-127), st: lost bits != 0
+struct __fp64_cdec { __fp64_c128 m; int e; bool st; bool ok; const char *p; };	// m * 10^e
+
+constexpr __fp64_c128 __fp64_cmul10( __fp64_c128 m, uint64_t l0, uint64_t l1 ) {
+	return __fp64_c128{ m.h * 10 + (l1 >> 32), (l1 << 32) | (l0 & 0xffffffffULL) };
+}
+
+// digits of the significand, with or without decimal point
+constexpr __fp64_cdec __fp64_cdigits( const char *s, __fp64_c128 m, int e, bool st, bool dot, bool any ) {
+	return *s == '.' && !dot ? __fp64_cdigits( s+1, m, e, st, true, any )
+		: *s < '0' || *s > '9' ? __fp64_cdec{ m, e, st, any, s }
+		: m.h < 0x0800000000000000ULL
+			? __fp64_cdigits( s+1, __fp64_cmul10( m, (m.l & 0xffffffffULL) * 10 + (*s - '0'),
+				(m.l >> 32) * 10 + (((m.l & 0xffffffffULL) * 10 + (*s - '0')) >> 32) ),
+				dot ? e-1 : e, st, dot, true )
+		: __fp64_cdigits( s+1, m, dot ? e : e+1, st || *s != '0', dot, true );
+}
+
+constexpr int __fp64_cint( const char *s, int x ) {	// decimal exponent, limited to 9999
+	return *s >= '0' && *s <= '9' ? __fp64_cint( s+1, x < 1000 ? x*10 + (*s - '0') : x ) : x;
+}
+
+constexpr const char *__fp64_cskip( const char *s ) {	// skip digits
+	return *s >= '0' && *s <= '9' ? __fp64_cskip( s+1 ) : s;
+}
+
+constexpr __fp64_c128 __fp64_cshl( __fp64_c128 x, int n ) {	// x << n, 0 <= n <= 64
+	return n == 0 ? x : n == 64 ? __fp64_c128{ x.l, 0 } : __fp64_c128{ x.h << n | x.l >> (64-n), x.l << n };
+}
+
+constexpr __fp64_cfp __fp64_cnorm( __fp64_cfp x, int n ) {	// normalize x != 0, n = 64, 32, ..., 1
+	return n == 0 ? x
+		: (n == 64 ? x.m.h == 0 : x.m.h >> (64-n) == 0)
+			? __fp64_cnorm( __fp64_cfp{ __fp64_cshl( x.m, n ), x.e - n, x.st }, n/2 )
+		: __fp64_cnorm( x, n/2 );
+}
+
+// 128 x 128 bit multiplication, column by column with 32 bit limbs
+constexpr uint64_t __fp64_climb( __fp64_c128 x, int i ) {
+	return ((i < 2 ? x.l : x.h) >> (i & 1 ? 32 : 0)) & 0xffffffffULL;
+}
+
+constexpr uint64_t __fp64_ccol( __fp64_c128 a, __fp64_c128 b, int k, int i, int hi ) {	// sum of a[i]*b[k-i]
+	return i > 3 || i > k ? 0
+		: (k-i > 3 ? 0 : (__fp64_climb( a, i ) * __fp64_climb( b, k-i ) >> hi) & 0xffffffffULL)
+		  + __fp64_ccol( a, b, k, i+1, hi );
+}
+
+constexpr __fp64_c128 __fp64_cor( __fp64_c128 x, int i, uint64_t v ) {	// set limb i of x to v
+	return i < 2 ? __fp64_c128{ x.h, x.l | v << (i & 1 ? 32 : 0) }
+		: __fp64_c128{ x.h | v << (i & 1 ? 32 : 0), x.l };
+}
+
+constexpr __fp64_c256 __fp64_cput( __fp64_c256 r, int k, uint64_t v ) {
+	return k < 4 ? __fp64_c256{ r.h, __fp64_cor( r.l, k, v ) } : __fp64_c256{ __fp64_cor( r.h, k-4, v ), r.l };
+}
+
+constexpr __fp64_c256 __fp64_cmulk( __fp64_c128 a, __fp64_c128 b, int k, uint64_t c, __fp64_c256 r );
+
+constexpr __fp64_c256 __fp64_cmulc( __fp64_c128 a, __fp64_c128 b, int k, uint64_t c, __fp64_c256 r ) {
+	return __fp64_cmulk( a, b, k+1, c >> 32, __fp64_cput( r, k, c & 0xffffffffULL ) );
+}
+
+constexpr __fp64_c256 __fp64_cmulk( __fp64_c128 a, __fp64_c128 b, int k, uint64_t c, __fp64_c256 r ) {
+	return k == 8 ? r
+		: __fp64_cmulc( a, b, k, c + __fp64_ccol( a, b, k, 0, 0 ) + (k ? __fp64_ccol( a, b, k-1, 0, 32 ) : 0), r );
+}
+
+constexpr __fp64_cfp __fp64_cmulp( __fp64_c256 p, int e, bool st ) {	// normalize product
+	return p.h.h >> 63 ? __fp64_cfp{ p.h, e + 1, st || p.l.h || p.l.l }
+		: __fp64_cfp{ __fp64_c128{ p.h.h << 1 | p.h.l >> 63, p.h.l << 1 | p.l.h >> 63 }, e, st || (p.l.h << 1) || p.l.l };
+}
+
+constexpr __fp64_cfp __fp64_cmul( __fp64_cfp a, __fp64_cfp b ) {
+	return __fp64_cmulp( __fp64_cmulk( a.m, b.m, 0, 0, __fp64_c256{ { 0, 0 }, { 0, 0 } } ), a.e + b.e, a.st || b.st );
+}
+
+// 10^(2^j), 10^-(2^j), rounded to 128 bits
+constexpr __fp64_cfp __fp64_cpow10( int j ) {
+	return j == 0 ? __fp64_cfp{ { 0xa000000000000000ULL, 0x0000000000000000ULL }, 3, false }	// 10^1
+		: j == 1 ? __fp64_cfp{ { 0xc800000000000000ULL, 0x0000000000000000ULL }, 6, false }	// 10^2
+		: j == 2 ? __fp64_cfp{ { 0x9c40000000000000ULL, 0x0000000000000000ULL }, 13, false }	// 10^4
+		: j == 3 ? __fp64_cfp{ { 0xbebc200000000000ULL, 0x0000000000000000ULL }, 26, false }	// 10^8
+		: j == 4 ? __fp64_cfp{ { 0x8e1bc9bf04000000ULL, 0x0000000000000000ULL }, 53, false }	// 10^16
+		: j == 5 ? __fp64_cfp{ { 0x9dc5ada82b70b59dULL, 0xf020000000000000ULL }, 106, false }	// 10^32
+		: j == 6 ? __fp64_cfp{ { 0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL }, 212, false }	// 10^64
+		: j == 7 ? __fp64_cfp{ { 0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL }, 425, false }	// 10^128
+		: __fp64_cfp{ { 0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab8ULL }, 850, false };	// 10^256
+}
+
+constexpr __fp64_cfp __fp64_cpow10n( int j ) {
+	return j == 0 ? __fp64_cfp{ { 0xccccccccccccccccULL, 0xcccccccccccccccdULL }, -4, false }	// 10^-1
+		: j == 1 ? __fp64_cfp{ { 0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL }, -7, false }	// 10^-2
+		: j == 2 ? __fp64_cfp{ { 0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL }, -14, false }	// 10^-4
+		: j == 3 ? __fp64_cfp{ { 0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3dULL }, -27, false }	// 10^-8
+		: j == 4 ? __fp64_cfp{ { 0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL }, -54, false }	// 10^-16
+		: j == 5 ? __fp64_cfp{ { 0xcfb11ead453994baULL, 0x67de18eda5814af2ULL }, -107, false }	// 10^-32
+		: j == 6 ? __fp64_cfp{ { 0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL }, -213, false }	// 10^-64
+		: j == 7 ? __fp64_cfp{ { 0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdfULL }, -426, false }	// 10^-128
+		: __fp64_cfp{ { 0xc0314325637a1939ULL, 0xfa911155fefb5309ULL }, -851, false };	// 10^-256
+}
+
+constexpr __fp64_cfp __fp64_cscale( __fp64_cfp x, int k, int j, bool neg ) {	// x * 10^(+-k)
+	return k == 0 ? x
+		: __fp64_cscale( k & 1 ? __fp64_cmul( x, neg ? __fp64_cpow10n( j ) : __fp64_cpow10( j ) ) : x, k >> 1, j+1, neg );
+}
+
+constexpr uint64_t __fp64_cpow5( int k ) {
+	return k == 0 ? 1 : 5 * __fp64_cpow5( k-1 );
+}
+
+/* rounding of x = m * 2^(e-127), with sh bits of m shifted out (75 <= sh <= 128)
+   For a negative decimal exponent -k, x is not exact. If it is close to a midpoint
+   t * 2^q (t odd), the decimal number d is checked for d * 10^-k == t * 2^q, i.e.
+   d == t * 5^k * 2^(q+k), to round exact ties to even. */
+constexpr bool __fp64_ceq( __fp64_cfp a, __fp64_cfp b ) {
+	return a.m.h == b.m.h && a.m.l == b.m.l && a.e == b.e;
+}
+
+constexpr bool __fp64_ctie( __fp64_cfp d, uint64_t t, int q, int k ) {
+	return k > 0 && k <= 27 && (t & 1)
+		&& __fp64_ceq( d, __fp64_cnorm( __fp64_cfp{ __fp64_cmulk( __fp64_c128{ 0, t }, __fp64_c128{ 0, __fp64_cpow5( k ) },
+			0, 0, __fp64_c256{ { 0, 0 }, { 0, 0 } } ).l, 127 + q + k, false }, 64 ) );
+}
+
+constexpr uint64_t __fp64_cround( bool st, uint64_t m, bool half, bool rest, bool tie ) {
+	return tie ? m + (st ? 1 : (m & 1)) : m + (half && (rest || (m & 1)));
+}
+
+constexpr uint64_t __fp64_cpack( __fp64_cfp x, __fp64_cfp d, int k, int sh ) {
+	return sh > 128 ? 0
+		: __fp64_cround( d.st, sh == 128 ? 0 : x.m.h >> (sh-64),
+			(x.m.h >> (sh-65)) & 1,
+			(x.m.h & ((1ULL << (sh-65)) - 1)) || x.m.l || x.st,
+			__fp64_ctie( d, (x.m.h >> (sh-65)) + ((x.m.h >> (sh-66)) & 1), x.e - 128 + sh, k ) );
+}
+
+constexpr float64_t __fp64_cvalue( __fp64_cfp x, __fp64_cfp d, int k ) {
+	return x.e + 1023 >= 2047 ? float64_PLUS_INFINITY
+		: x.e + 1023 >= 1
+			? ((float64_t)(x.e + 1022) << 52) + __fp64_cpack( x, d, k, 75 )
+		: __fp64_cpack( x, d, k, 75 + 1 - (x.e + 1023) );
+}
+
+constexpr float64_t __fp64_cconv( __fp64_cfp d, int e ) {
+	return e > 310 ? float64_PLUS_INFINITY
+		: e < -380 ? float64_NUMBER_PLUS_ZERO
+		: __fp64_cvalue( __fp64_cscale( d, e < 0 ? -e : e, 0, e < 0 ), d, e < 0 ? -e : 0 );
+}
+
+constexpr float64_t __fp64_cdecimal( __fp64_cdec d, int e ) {
+	return d.m.h == 0 && d.m.l == 0 ? float64_NUMBER_PLUS_ZERO
+		: __fp64_cconv( __fp64_cnorm( __fp64_cfp{ d.m, 127, d.st }, 64 ), e );
+}
+
+constexpr float64_t __fp64_cexp( __fp64_cdec d, const char *s, int sign ) {	// exponent part
+	return *s < '0' || *s > '9' || *__fp64_cskip( s ) != 0 ? __fp64_invalid_literal()
+		: __fp64_cdecimal( d, d.e + sign * __fp64_cint( s, 0 ) );
+}
+
+constexpr float64_t __fp64_cparse( __fp64_cdec d ) {
+	return !d.ok ? __fp64_invalid_literal()
+		: *d.p == 'e' || *d.p == 'E'
+			? __fp64_cexp( d, d.p[1] == '-' || d.p[1] == '+' ? d.p+2 : d.p+1, d.p[1] == '-' ? -1 : 1 )
+		: *d.p != 0 ? __fp64_invalid_literal()
+		: __fp64_cdecimal( d, d.e );
+}
+
+constexpr float64_t __fp64_cunsigned( const char *s ) {
+	return __fp64_cparse( __fp64_cdigits( s, __fp64_c128{ 0, 0 }, 0, false, false, false ) );
+}
+
+constexpr float64_t fp64_const( const char *s ) {	// bit pattern of the decimal number in s
+	return *s == '-' ? float64_NUMBER_MINUS_ZERO | __fp64_cunsigned( s+1 )
+		: __fp64_cunsigned( *s == '+' ? s+1 : s );
+}
+
+template<float64_t x> struct __fp64_cconst {
+	static constexpr float64_t value() { return x; }
+};
+#define FP64_CONST(s)	(__fp64_cconst<fp64_const(s)>::value())
+
+constexpr float64_t operator"" _fp64( const char *s, size_t ) {	// "1.2345"_fp64
+	return fp64_const( s );
+}
+#endif
 #endif
 
 #endif
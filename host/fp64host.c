@@ -0,0 +1,1276 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64host.c
+   Host build of the arithmetic, comparison, rounding and conversion
+   functions of fp64lib. Every function follows the corresponding
+   assembler routine (given in brackets), so that the results are bit
+   identical to the ones on the AVR:
+   - all NaN results are 0x7ff8000000000000, except where the assembler
+     code passes an argument through (fp64_fmin, fp64_fmax, fp64_scalbln,
+     fp64_fma with NaN as C)
+   - fp64_add/fp64_sub/fp64_mul round with the 3 guard bits of the
+     unpacked format as __fp64_rpretA does, fp64_mul ignores the partial
+     products below 2^-40 of the 112 bit product as __fp64_mulsd3x does
+   - fp64_fmod returns 0 if the exponents of x and y differ by 54 or more
+   - fp64_ds truncates, fp64_sd returns +0.0 for -0.0f
+   - conversions to integer do not saturate, see __fp64_fixxdfxi
+   As on the AVR, int is 16 bit and long is 32 bit: arguments of these
+   types are truncated, results are sign extended.
+   Not available on the host are the transcendental functions, fp64_pow,
+   fp64_powi, fp64_hypot, fp64_cbrt, fp64_rsqrt, fp64_logb, fp64_strtod,
+   fp64_atof, fp64x_*, fp64_poly* and the vector functions.
+*/
+
+#include "fp64host.h"
+
+/* unpacking and packing **************************************************/
+
+/* split x into sign, exponent and 56 bit significand [__fp64_splitA] */
+uint8_t __fp64_splitA( fp64_split_t *a, float64_t x )
+{
+	uint64_t f = x & 0x000fffffffffffffULL;
+
+	a->s = x >> 63;
+	a->e = (x >> 52) & 0x7ff;
+	if( a->e == 0x7ff ) {
+		a->m = f << 4;		// NaN stays NaN
+		return f ? FP64_ISNAN : FP64_INFINITE;
+	}
+	if( a->e == 0 ) {
+		a->m = f << 3;		// subnormal number has exponent 1
+		a->e = f ? 1 : 0;
+		return f ? FP64_FINITE : FP64_ZERO;
+	}
+	a->m = (f | 0x0010000000000000ULL) << 3;
+	return FP64_FINITE;
+}
+
+/* pack a, guard bits are truncated [__fp64_pretA] */
+float64_t __fp64_pretA( const fp64_split_t *a )
+{
+	uint64_t m = a->m;
+	uint16_t e = a->e;
+	uint8_t lo, hi, r7, r6;
+
+	if( e == 0 )
+		m >>= 1;			// save topmost bit for subnormal number
+	else if( !(m & FP64_B55) ) {
+		e = 0;				// no leading 1 bit --> subnormal number
+		m >>= 1;
+	}
+	m >>= 3;
+	lo = e;
+	hi = e >> 8;
+	r7 = ((lo >> 4) & 0x0f) | (uint8_t) ((hi << 4) | (hi >> 4));
+	r7 = (r7 & 0x7f) | (a->s << 7);
+	r6 = ((m >> 48) & 0x0f) | (uint8_t) (lo << 4);
+	return ((uint64_t) r7 << 56) | ((uint64_t) r6 << 48) | (m & 0x0000ffffffffffffULL);
+}
+
+/* round to even with the 3 guard bits and pack a [__fp64_rpretA]
+   subnormal numbers are shifted one more bit by __fp64_pretA, so they
+   are rounded with 4 guard bits */
+float64_t __fp64_rpretA( const fp64_split_t *a )
+{
+	fp64_split_t r = *a;
+
+	if( r.e == 0 || !(r.m & FP64_B55) ) {
+		r.e = 0;
+		if( (r.m & 8) && (r.m & 0x17) ) {
+			r.m += 0x10;
+			if( r.m > FP64_M56 ) {
+				r.m = (r.m & FP64_M56) >> 1 | FP64_B55;
+				r.e = 1;	// smallest normal number
+			}
+		}
+	} else if( (r.m & 4) && (r.m & 0x0b) ) {
+		r.m += 8;
+		if( r.m > FP64_M56 ) {
+			r.m = (r.m & FP64_M56) >> 1 | FP64_B55;
+			if( ++r.e == 0x7ff )
+				return __fp64_inf( r.s );
+		}
+	}
+	return __fp64_pretA( &r );
+}
+
+float64_t __fp64_inf( uint8_t s )
+{
+	return FP64_INF | ((uint64_t) s << 63);
+}
+
+float64_t __fp64_szero( uint8_t s )
+{
+	return (uint64_t) s << 63;
+}
+
+/* normalize a subnormal significand [__fp64_norm2] */
+static void fp64_norm2( fp64_split_t *a )
+{
+	do {
+		a->e--;
+		a->m = (a->m << 1) & FP64_M56;
+	} while( !(a->m & FP64_B55) );
+}
+
+/* 128 bit helpers ********************************************************/
+
+fp64_u128_t __fp64_mul128( uint64_t a, uint64_t b )
+{
+	uint64_t a0 = (uint32_t) a, a1 = a >> 32;
+	uint64_t b0 = (uint32_t) b, b1 = b >> 32;
+	uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	uint64_t mid = (p00 >> 32) + (uint32_t) p01 + (uint32_t) p10;
+	fp64_u128_t r;
+
+	r.lo = (mid << 32) | (uint32_t) p00;
+	r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+	return r;
+}
+
+fp64_u128_t __fp64_shl128( fp64_u128_t a, uint8_t n )
+{
+	if( n >= 128 ) {
+		a.hi = a.lo = 0;
+	} else if( n >= 64 ) {
+		a.hi = a.lo << (n - 64);
+		a.lo = 0;
+	} else if( n ) {
+		a.hi = (a.hi << n) | (a.lo >> (64 - n));
+		a.lo <<= n;
+	}
+	return a;
+}
+
+fp64_u128_t __fp64_shr128( fp64_u128_t a, uint8_t n )
+{
+	if( n >= 128 ) {
+		a.hi = a.lo = 0;
+	} else if( n >= 64 ) {
+		a.lo = a.hi >> (n - 64);
+		a.hi = 0;
+	} else if( n ) {
+		a.lo = (a.lo >> n) | (a.hi << (64 - n));
+		a.hi >>= n;
+	}
+	return a;
+}
+
+uint8_t __fp64_clz128( fp64_u128_t a )
+{
+	uint8_t n = 0;
+	uint64_t x = a.hi;
+
+	if( !x ) {
+		x = a.lo;
+		n = 64;
+		if( !x )
+			return 128;
+	}
+	while( !(x & FP64_SIGN) ) {
+		x <<= 1;
+		n++;
+	}
+	return n;
+}
+
+static fp64_u128_t fp64_add128( fp64_u128_t a, fp64_u128_t b )
+{
+	a.lo += b.lo;
+	a.hi += b.hi + (a.lo < b.lo);
+	return a;
+}
+
+static fp64_u128_t fp64_sub128( fp64_u128_t a, fp64_u128_t b )
+{
+	a.hi -= b.hi + (a.lo < b.lo);
+	a.lo -= b.lo;
+	return a;
+}
+
+/* bits of the exact value s * r * 2^x, rounded to nearest even, sticky
+   signals further bits != 0 below r */
+static float64_t fp64_round128( uint8_t s, fp64_u128_t r, int x, uint8_t sticky )
+{
+	int p = 127 - __fp64_clz128( r );	// position of leading 1 bit
+	int e = p + x + 1023;				// biased exponent
+	int sh = (e >= 1) ? p - 52 : -1074 - x;
+	uint64_t q, half, rest;
+	fp64_u128_t t;
+
+	if( sh <= 0 ) {
+		q = __fp64_shl128( r, -sh ).lo;	// exact, sticky is below half an ulp
+	} else if( sh > 127 ) {
+		q = 0;
+		rest = 1;						// r < 2^-1075, less than half an ulp
+	} else {
+		t = __fp64_shr128( r, sh );
+		q = t.lo;
+		t = fp64_sub128( r, __fp64_shl128( t, sh ) );	// bits shifted out
+		half = 0;
+		rest = sticky;
+		if( sh > 64 ) {
+			half = (t.hi >> (sh - 65)) & 1;
+			rest |= (t.hi & ((1ULL << (sh - 65)) - 1)) | t.lo;
+		} else {
+			half = (t.lo >> (sh - 1)) & 1;
+			rest |= t.lo & ((1ULL << (sh - 1)) - 1);
+		}
+		if( half && (rest || (q & 1)) )
+			q++;
+	}
+	if( e >= 1 )
+		q += (uint64_t) (e - 1) << 52;	// carry of rounding increments the exponent
+	if( q >= FP64_INF )
+		return __fp64_inf( s );
+	return q | ((uint64_t) s << 63);
+}
+
+/* add, sub ***************************************************************/
+
+/* A + B or A - B (sub = 1) [__fp64addsf3x] */
+static float64_t fp64_addsub( float64_t A, float64_t B, uint8_t sub )
+{
+	fp64_split_t a, b, t;
+	uint8_t ca = __fp64_splitA( &a, A );
+	uint8_t cb = __fp64_splitA( &b, B );
+	uint8_t op = sub;
+	uint16_t d;
+
+	if( ca == FP64_ISNAN || cb == FP64_ISNAN )
+		return FP64_NAN;
+	if( ca == FP64_INFINITE ) {
+		if( cb != FP64_INFINITE )
+			return __fp64_inf( a.s );
+		if( (a.s == b.s) != sub )
+			return __fp64_inf( a.s );
+		return FP64_NAN;
+	}
+	if( cb == FP64_INFINITE )
+		return __fp64_inf( b.s ^ sub );
+
+	if( ca == FP64_ZERO || cb == FP64_ZERO ) {
+		if( ca == FP64_ZERO ) {
+			if( cb == FP64_ZERO )
+				b.s = a.s & (b.s ^ sub);	// -0 only for -0 + -0 and -0 - +0
+			else
+				b.s ^= sub;
+			a = b;
+		}
+		if( !(a.m & FP64_B55) ) {			// case 12
+			a.m = (a.m << 1) & FP64_M56;
+			a.e--;
+		}
+		return __fp64_pretA( &a );
+	}
+
+	// __fp64_add_pse: both are finite and != 0
+	if( a.e == b.e && a.m == b.m ) {
+		if( a.s ^ b.s ^ sub )
+			return 0;						// A - A
+		op = 0;								// A + A
+	} else if( a.e > b.e || (a.e == b.e && a.m > b.m) ) {
+		if( a.s != b.s )
+			op ^= 1;
+	} else {
+		if( a.s != b.s )
+			op ^= 1;
+		b.s ^= sub;
+		t = a;
+		a = b;
+		b = t;
+	}
+
+	d = b.e - a.e;
+	if( d != 0 ) {
+		if( (d >> 8) < 0xff || (d & 0xff) < 0xcb )
+			goto ret;						// B is too small to matter
+		uint8_t n = 0x100 - (d & 0xff);
+		uint8_t lost = (b.m & ((1ULL << n) - 1)) != 0;
+		b.m = (b.m >> n) | lost;
+	}
+	if( op ) {
+		a.m -= b.m;
+		for( ;; ) {
+			if( a.m & FP64_B55 )
+				goto ret;
+			if( a.e-- <= 1 ) {				// underflow --> subnormal number
+				a.m <<= 1;
+				return __fp64_rpretA( &a );
+			}
+			a.m <<= 1;
+		}
+	} else {
+		a.m += b.m;
+		if( a.m > FP64_M56 ) {
+			a.m >>= 1;
+			if( ++a.e == 0x7ff )
+				return __fp64_inf( a.s );
+		}
+	}
+ret:
+	if( !(a.m & FP64_B55) ) {
+		a.e--;
+		a.m <<= 1;
+	}
+	return __fp64_rpretA( &a );
+}
+
+float64_t fp64_add( float64_t a, float64_t b )
+{
+	return fp64_addsub( a, b, 0 );
+}
+
+float64_t fp64_sub( float64_t a, float64_t b )
+{
+	return fp64_addsub( a, b, 1 );
+}
+
+/* mul ********************************************************************/
+
+/* exponent and 72 bit significand of A*B as computed by __fp64_mulsd3_pse0:
+   the partial products a[i]*b[j] with i+j < 5 of the bytes of the
+   significands are not computed */
+static float64_t fp64_mul_pse( fp64_split_t *a, const fp64_split_t *b )
+{
+	uint64_t low = 0, plo;
+	uint8_t phi, sticky = 0;
+	fp64_u128_t p;
+	int i, j;
+
+	for( i = 0; i < 5; i++ )
+		for( j = 0; i + j < 5; j++ )
+			low += ((a->m >> (8*i)) & 0xff) * ((b->m >> (8*j)) & 0xff) << (8*(i+j));
+	p = __fp64_mul128( a->m, b->m );
+	p.hi -= (p.lo < low);
+	p.lo -= low;
+	p = __fp64_shr128( p, 40 );
+	plo = p.lo;
+	phi = p.hi;
+	a->e += b->e;
+	if( !phi && !plo )
+		return __fp64_szero( a->s );
+	while( !(phi & 0x80) ) {
+		phi = (phi << 1) | (plo >> 63);
+		plo <<= 1;
+		a->e--;
+	}
+	a->e -= 0x3fe;
+	if( (int16_t) a->e < 0 ) {
+		if( (int8_t) a->e < -52 || (a->e >> 8) != 0xff )
+			return __fp64_szero( a->s );
+		do {
+			sticky += plo & 1;
+			plo = (plo >> 1) | ((uint64_t) phi << 63);
+			phi >>= 1;
+		} while( (int16_t) ++a->e < 0 );
+	} else if( a->e >= 0x7ff ) {
+		return __fp64_inf( a->s );
+	}
+	a->m = ((uint64_t) phi << 48) | (plo >> 16);
+	if( (plo & 0xffff) || sticky )
+		a->m |= 1;
+	return __fp64_rpretA( a );
+}
+
+float64_t fp64_mul( float64_t A, float64_t B )
+{
+	fp64_split_t a, b;
+	uint8_t ca = __fp64_splitA( &a, A );
+	uint8_t cb = __fp64_splitA( &b, B );
+
+	a.s ^= b.s;
+	if( ca == FP64_ISNAN || cb == FP64_ISNAN )
+		return FP64_NAN;
+	if( ca == FP64_INFINITE || cb == FP64_INFINITE ) {
+		if( ca == FP64_ZERO || cb == FP64_ZERO )
+			return FP64_NAN;				// 0 * Inf
+		return __fp64_inf( a.s );
+	}
+	if( ca == FP64_ZERO || cb == FP64_ZERO )
+		return __fp64_szero( a.s );
+	return fp64_mul_pse( &a, &b );
+}
+
+float64_t fp64_square( float64_t x )
+{
+	return fp64_mul( x, x );
+}
+
+/* div ********************************************************************/
+
+/* A / B, the significand of the quotient is computed with 56 bits and
+   a sticky bit for the remainder [__fp64_divsd3x] */
+float64_t fp64_div( float64_t A, float64_t B )
+{
+	fp64_split_t a, b;
+	uint8_t ca = __fp64_splitA( &a, A );
+	uint8_t cb = __fp64_splitA( &b, B );
+	int16_t e;
+	uint64_t q = 0, r;
+	int i;
+
+	a.s ^= b.s;
+	if( ca == FP64_ISNAN || cb == FP64_ISNAN )
+		return FP64_NAN;
+	if( ca == FP64_INFINITE )
+		return (cb == FP64_FINITE) ? __fp64_inf( a.s ) : FP64_NAN;
+	if( cb == FP64_INFINITE )
+		return __fp64_szero( a.s );
+	if( ca == FP64_ZERO )
+		return (cb == FP64_ZERO) ? FP64_NAN : __fp64_szero( a.s );
+	if( cb == FP64_ZERO )
+		return __fp64_inf( a.s );
+
+	if( !(a.m & FP64_B55) )
+		fp64_norm2( &a );
+	if( !(b.m & FP64_B55) )
+		fp64_norm2( &b );
+	e = (int16_t) a.e - (int16_t) b.e;
+	r = a.m;
+	if( r < b.m ) {
+		r <<= 1;
+		e--;
+	}
+	for( i = 0; i < 56; i++ ) {
+		q <<= 1;
+		if( r >= b.m ) {
+			r -= b.m;
+			q |= 1;
+		}
+		r <<= 1;
+	}
+	a.m = q | (r != 0);
+	e += 1023;
+	if( e <= 0 ) {
+		if( e < -55 )
+			return __fp64_szero( a.s );
+		while( e < 1 ) {
+			a.m = (a.m >> 1) | (a.m & 1);
+			e++;
+		}
+		a.e = 1;
+		a.m |= FP64_B55;					// round and pack as 2^-1022 + A
+		return __fp64_rpretA( &a ) - 0x0010000000000000ULL;
+	}
+	if( e >= 0x7ff )
+		return __fp64_inf( a.s );
+	a.e = e;
+	return __fp64_rpretA( &a );
+}
+
+float64_t fp64_inverse( float64_t x )
+{
+	return fp64_div( FP64_ONE, x );
+}
+
+/* sqrt *******************************************************************/
+
+/* square root, correctly rounded [fp64_sqrt] */
+float64_t fp64_sqrt( float64_t x )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+	uint64_t m, root = 0, rem = 0;
+	int16_t e;
+	int k;
+
+	if( c == FP64_ISNAN )
+		return FP64_NAN;
+	if( c == FP64_INFINITE )
+		return a.s ? FP64_NAN : FP64_INF;
+	if( c == FP64_ZERO )
+		return x;
+	if( a.s )
+		return FP64_NAN;
+	if( !(a.m & FP64_B55) )
+		fp64_norm2( &a );
+	m = a.m >> 3;							// 53 bits
+	e = (int16_t) a.e - 1023;
+	if( e & 1 ) {
+		m <<= 1;
+		e--;
+	}
+	// root = isqrt(m * 2^56), 2 bits of the radicand per step
+	for( k = 54; k >= 0; k-- ) {
+		uint64_t bits = (2*k >= 56) ? (m >> (2*k - 56)) & 3 : 0;
+		rem = (rem << 2) | bits;
+		root <<= 1;
+		if( rem >= 2*root + 1 ) {
+			rem -= 2*root + 1;
+			root |= 1;
+		}
+	}
+	a.m = (root << 1) | (rem != 0);
+	a.e = e/2 + 1023;
+	return __fp64_rpretA( &a );
+}
+
+/* fmod *******************************************************************/
+
+/* x - n*y with n = trunc(x/y), n is stored in *np [fp64_fmodn] */
+float64_t fp64_fmodn( float64_t A, float64_t B, unsigned long *np )
+{
+	fp64_split_t a, b;
+	uint8_t ca = __fp64_splitA( &a, A );
+	uint8_t cb = __fp64_splitA( &b, B & ~FP64_SIGN );
+	uint32_t n = 0;
+	uint64_t am, bm;
+	int16_t d, e;
+	float64_t r;
+
+	if( ca == FP64_ISNAN || cb == FP64_ISNAN || ca == FP64_INFINITE ) {
+		r = FP64_NAN;
+	} else if( cb == FP64_INFINITE ) {
+		if( !(a.m & FP64_B55) ) {			// .L_subA
+			a.m <<= 1;
+			a.e = 0;
+		}
+		r = __fp64_pretA( &a );
+	} else if( ca == FP64_ZERO ) {
+		r = (cb == FP64_ZERO) ? FP64_NAN : __fp64_szero( a.s );
+	} else if( cb == FP64_ZERO ) {
+		r = FP64_NAN;
+	} else if( a.e < b.e || (a.e == b.e && a.m < b.m) ) {
+		if( !(a.m & FP64_B55) ) {
+			a.m <<= 1;
+			a.e = 0;
+		}
+		r = __fp64_rpretA( &a );
+	} else if( a.e == b.e && a.m == b.m ) {
+		n = 1;
+		r = __fp64_szero( a.s );
+	} else {
+		// __fp64_fmod_pse, fabs(A) > fabs(B)
+		if( !(a.m & FP64_B55) )
+			fp64_norm2( &a );
+		if( !(b.m & FP64_B55) )
+			fp64_norm2( &b );
+		d = a.e - b.e;
+		if( (d >> 8) != 0 || (uint8_t) d >= 54 ) {
+			r = __fp64_szero( a.s );		// can not be determined exactly
+			goto store;
+		}
+		am = a.m;
+		bm = b.m;
+		for( ;; ) {
+			n++;
+			am -= bm;
+			if( !am ) {						// A is a 2^d multiple of B
+				while( --d >= 0 )
+					n <<= 1;
+				r = __fp64_szero( a.s );
+				goto store;
+			}
+			if( am & FP64_SIGN ) {
+				n--;
+				am += bm;
+			}
+			if( --d < 0 )
+				break;
+			n <<= 1;
+			am <<= 1;
+		}
+		e = b.e - 1;
+		if( e < 0 ) {
+			do {
+				am >>= 1;
+			} while( ++e != 0 );
+			e = 1;
+		} else if( e == 0 ) {
+			e = 1;
+		} else {
+			while( !(am & FP64_B55) ) {
+				am <<= 1;
+				if( --e == 0 )
+					break;
+			}
+			e++;
+		}
+		a.m = am;
+		a.e = e;
+		if( !(a.m & FP64_B55) ) {
+			a.m <<= 1;
+			a.e = 0;
+		}
+		r = __fp64_rpretA( &a );
+	}
+store:
+	if( np )
+		*np = n;
+	return r;
+}
+
+float64_t fp64_fmod( float64_t A, float64_t B )
+{
+	return fp64_fmodn( A, B, NULL );
+}
+
+/* fma ********************************************************************/
+
+/* A * B + C with a single rounding [fp64_fma] */
+float64_t fp64_fma( float64_t A, float64_t B, float64_t C )
+{
+	fp64_split_t a, b, c;
+	uint8_t ca = __fp64_splitA( &a, A );
+	uint8_t cb = __fp64_splitA( &b, B );
+	uint8_t cc = __fp64_splitA( &c, C );
+	fp64_u128_t p, q, t;
+	int xp, xq, d;
+	uint8_t sp, sq, sticky = 0, n;
+
+	if( ca != FP64_FINITE || cb != FP64_FINITE )
+		return fp64_add( fp64_mul( A, B ), C );
+	if( cc == FP64_ISNAN || cc == FP64_INFINITE )
+		return C;
+
+	// exact product p * 2^xp, value of an unpacked number is m * 2^(e-1078)
+	sp = a.s ^ b.s;
+	p = __fp64_mul128( a.m, b.m );
+	xp = (int) a.e + b.e - 2*1078;
+	if( cc == FP64_ZERO )
+		return fp64_round128( sp, p, xp, 0 );
+
+	// align both summands with the leading 1 bit at bit 126
+	n = __fp64_clz128( p ) - 1;
+	p = __fp64_shl128( p, n );
+	xp -= n;
+	q.hi = 0;
+	q.lo = c.m;
+	sq = c.s;
+	xq = (int) c.e - 1078;
+	n = __fp64_clz128( q ) - 1;
+	q = __fp64_shl128( q, n );
+	xq -= n;
+	if( xq > xp ) {							// p is the larger one
+		t = p; p = q; q = t;
+		d = xp; xp = xq; xq = d;
+		n = sp; sp = sq; sq = n;
+	}
+	d = xp - xq;
+	if( d > 0 ) {
+		if( d > 128 )
+			d = 128;						// q is only sticky
+		t = fp64_sub128( q, __fp64_shl128( __fp64_shr128( q, d ), d ) );
+		q = __fp64_shr128( q, d );
+		sticky = (t.hi | t.lo) != 0;
+	}
+	if( sp == sq ) {
+		p = fp64_add128( p, q );
+	} else {
+		if( q.hi > p.hi || (q.hi == p.hi && q.lo > p.lo) ) {
+			t = p; p = q; q = t;
+			sp = sq;
+		}
+		if( sticky ) {						// the lost bits belong to the subtrahend
+			t.hi = 0;
+			t.lo = 1;
+			q = fp64_add128( q, t );
+		}
+		p = fp64_sub128( p, q );
+		if( !p.hi && !p.lo )
+			return 0;						// exact zero is +0.0
+	}
+	return fp64_round128( sp, p, xp, sticky );
+}
+
+/* comparison and classification ******************************************/
+
+static uint8_t fp64_isnanbits( float64_t x )
+{
+	return (x & ~FP64_SIGN) > FP64_INF;
+}
+
+/* -1, 0 or 1 for A < B, A == B, A > B, 1 if A or B is NaN [__fp64_cmp] */
+int8_t fp64_compare( float64_t A, float64_t B )
+{
+	uint64_t a = A & ~FP64_SIGN, b = B & ~FP64_SIGN;
+
+	if( fp64_isnanbits( A ) || fp64_isnanbits( B ) )
+		return 1;
+	if( a == b ) {
+		if( (A ^ B) & FP64_SIGN && b )
+			return (B & FP64_SIGN) ? 1 : -1;
+		return 0;
+	}
+	if( (A ^ B) & FP64_SIGN )
+		return (B & FP64_SIGN) ? 1 : -1;
+	return ((a < b) != ((A & FP64_SIGN) != 0)) ? -1 : 1;
+}
+
+int fp64_classify( float64_t x )
+{
+	uint64_t a = x & ~FP64_SIGN;
+
+	if( a > FP64_INF )
+		return FP_NAN;
+	if( a == FP64_INF )
+		return FP_INFINITE;
+	if( a == 0 )
+		return FP_ZERO;
+	if( a < 0x0010000000000000ULL )
+		return FP_SUBNORMAL;
+	return FP_NORMAL;
+}
+
+int fp64_isinf( float64_t x )
+{
+	if( (x & ~FP64_SIGN) != FP64_INF )
+		return 0;
+	return (x & FP64_SIGN) ? -1 : 1;
+}
+
+int fp64_isnan( float64_t x )
+{
+	return fp64_isnanbits( x );
+}
+
+int fp64_isfinite( float64_t x )
+{
+	return (x & ~FP64_SIGN) < FP64_INF;
+}
+
+int fp64_signbit( float64_t x )
+{
+	return x >> 63;
+}
+
+/* [fp64_fmax] */
+static float64_t fp64_minmax( float64_t A, float64_t B, uint8_t min )
+{
+	uint8_t sa = A >> 63, sb = B >> 63, lt;
+
+	if( fp64_isnanbits( A ) )
+		return B;
+	if( fp64_isnanbits( B ) )
+		return A;
+	if( sa != sb )
+		return (sa ^ min) ? B : A;
+	if( min )
+		lt = (B & ~FP64_SIGN) < (A & ~FP64_SIGN);
+	else
+		lt = (A & ~FP64_SIGN) < (B & ~FP64_SIGN);
+	return (lt == sa) ? A : B;
+}
+
+float64_t fp64_fmin( float64_t A, float64_t B )
+{
+	return fp64_minmax( A, B, 1 );
+}
+
+float64_t fp64_fmax( float64_t A, float64_t B )
+{
+	return fp64_minmax( A, B, 0 );
+}
+
+/* max(A-B, 0) [fp64_fdim] */
+float64_t fp64_fdim( float64_t A, float64_t B )
+{
+	uint8_t less;
+
+	if( !((A | B) & FP64_SIGN) )
+		less = A < B;
+	else
+		less = B < A;
+	if( !less )
+		return fp64_sub( A, B );
+	if( fp64_isnanbits( A ) || fp64_isnanbits( B ) )
+		return FP64_NAN;
+	return 0;
+}
+
+float64_t fp64_neg( float64_t x )
+{
+	return x ^ FP64_SIGN;
+}
+
+float64_t fp64_abs( float64_t x )
+{
+	return x & ~FP64_SIGN;
+}
+
+/* exponent functions *****************************************************/
+
+int fp64_ilogb( float64_t x )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+
+	if( c == FP64_ISNAN )
+		return FP_ILOGBNAN;
+	if( c == FP64_INFINITE )
+		return 0x7fff;
+	if( c == FP64_ZERO )
+		return FP_ILOGB0;
+	if( !(a.m & FP64_B55) )
+		fp64_norm2( &a );
+	return (int16_t) (a.e - 1023);
+}
+
+float64_t fp64_frexp( float64_t x, int *pexp )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+
+	if( pexp )
+		*pexp = 0;
+	if( c == FP64_ISNAN )
+		return FP64_NAN;
+	if( c == FP64_INFINITE )
+		return __fp64_inf( a.s );
+	if( c == FP64_ZERO )
+		return x;
+	a.e -= 1022;
+	if( !(a.m & FP64_B55) )
+		fp64_norm2( &a );
+	if( pexp )
+		*pexp = (int16_t) a.e;
+	a.e = 0x3fe;
+	return __fp64_pretA( &a );
+}
+
+/* round and pack a with a normalized significand and any exponent
+   [__fp64_ldexp_pse] */
+static float64_t fp64_ldexp_pse( fp64_split_t *a )
+{
+	uint8_t lo;
+
+	if( (int16_t) a->e >= 0x7ff )
+		return __fp64_inf( a->s );
+	if( (int16_t) a->e > 0 )
+		return __fp64_rpretA( a );
+	if( a->e != 0 && ((a->e >> 8) != 0xff || (a->e & 0xff) < 0xcc) )
+		return __fp64_szero( a->s );
+	lo = a->e;
+	do {
+		a->m = (a->m >> 1) | (a->m & 1);	// keep shifted out bits as sticky bit
+	} while( ++lo != 1 );
+	a->e = 1;
+	a->m |= FP64_B55;						// round and pack as 2^-1022 + A
+	return __fp64_rpretA( a ) - 0x0010000000000000ULL;
+}
+
+static float64_t fp64_scale( fp64_split_t *a, int16_t n )
+{
+	int32_t e;
+
+	if( !(a->m & FP64_B55) )
+		fp64_norm2( a );
+	e = (int32_t) (int16_t) a->e + n;
+	if( e > INT16_MAX || e < INT16_MIN )
+		return __fp64_inf( a->s );			// signed overflow of the exponent
+	a->e = e;
+	return fp64_ldexp_pse( a );
+}
+
+float64_t fp64_ldexp( float64_t x, int exp )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+
+	if( c == FP64_ISNAN )
+		return FP64_NAN;
+	if( c == FP64_INFINITE )
+		return __fp64_inf( a.s );
+	if( c == FP64_ZERO )
+		return x;
+	return fp64_scale( &a, (int16_t) exp );
+}
+
+float64_t fp64_scalbn( float64_t x, int ex )
+{
+	return fp64_ldexp( x, ex );
+}
+
+float64_t fp64_scalbln( float64_t x, long ex )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+	int32_t n = (int32_t) ex;
+
+	if( c == FP64_ISNAN )
+		return x & ~FP64_SIGN;				// NaN is returned as is, without sign
+	if( c == FP64_INFINITE )
+		return x;
+	if( c == FP64_ZERO )
+		return x;
+	if( n > 0x7fff )
+		return __fp64_inf( a.s );
+	if( n < -0x7f00 )
+		return __fp64_szero( a.s );
+	return fp64_scale( &a, (int16_t) n );
+}
+
+/* rounding to integral values ********************************************/
+
+/* x without the fractional bits, |x| < 2^52 and >= 1 */
+static float64_t fp64_cut( float64_t x )
+{
+	int e = ((x >> 52) & 0x7ff) - 1023;
+
+	return x & ~(0x000fffffffffffffULL >> e);
+}
+
+/* [fp64_trunc] */
+float64_t fp64_trunc( float64_t x )
+{
+	uint64_t a = x & ~FP64_SIGN;
+
+	if( a > FP64_INF )
+		return FP64_NAN;
+	if( a < FP64_ONE )
+		return x & FP64_SIGN;
+	if( a >= 0x4330000000000000ULL )		// |x| >= 2^52, Inf
+		return x;
+	return fp64_cut( x );
+}
+
+float64_t fp64_cut_noninteger_fraction( float64_t x )
+{
+	return fp64_trunc( x );
+}
+
+/* [fp64_ceil] */
+float64_t fp64_ceil( float64_t x )
+{
+	uint64_t a = x & ~FP64_SIGN;
+	float64_t t;
+
+	if( a > FP64_INF )
+		return FP64_NAN;
+	if( x & FP64_SIGN )
+		return fp64_trunc( x );
+	if( a == 0 )
+		return x;
+	if( a < FP64_ONE )
+		return FP64_ONE;
+	if( a >= 0x4330000000000000ULL )
+		return x;
+	t = fp64_cut( x );
+	if( t != x )
+		t = fp64_add( t, FP64_ONE );
+	return t;
+}
+
+/* [fp64_floor] */
+float64_t fp64_floor( float64_t x )
+{
+	float64_t r = fp64_ceil( x ^ FP64_SIGN );
+
+	return (r == FP64_NAN) ? r : r ^ FP64_SIGN;
+}
+
+/* [fp64_round] */
+float64_t fp64_round( float64_t x )
+{
+	uint64_t a = x & ~FP64_SIGN;
+	float64_t t;
+
+	if( a > FP64_INF )
+		return FP64_NAN;
+	if( a < 0x3fe0000000000000ULL )			// |x| < 0.5
+		return x & FP64_SIGN;
+	if( a < FP64_ONE )
+		return FP64_ONE | (x & FP64_SIGN);
+	if( a >= 0x4330000000000000ULL )
+		return x;
+	t = fp64_cut( x );
+	if( fp64_sub( a, t & ~FP64_SIGN ) >= 0x3fe0000000000000ULL )
+		t = fp64_add( t, FP64_ONE | (x & FP64_SIGN) );
+	return t;
+}
+
+/* [fp64_modf] */
+float64_t fp64_modf( float64_t x, float64_t *iptr )
+{
+	uint64_t a = x & ~FP64_SIGN;
+	float64_t i, f;
+
+	if( a > FP64_INF ) {
+		i = f = FP64_NAN;
+	} else if( a == FP64_INF ) {
+		i = x;
+		f = x & FP64_SIGN;
+	} else if( a < FP64_ONE ) {
+		i = x & FP64_SIGN;
+		f = x;
+	} else if( a >= 0x4340000000000000ULL ) {	// |x| >= 2^53
+		i = x;
+		f = x & FP64_SIGN;
+	} else {
+		i = fp64_cut( x );
+		f = fp64_sub( x, i );
+		if( !(f & ~FP64_SIGN) )
+			f = x & FP64_SIGN;
+	}
+	if( iptr )
+		*iptr = i;
+	return f;
+}
+
+/* x rounded to long, ties away from zero (lround) or to even (lrint),
+   0x80000000 for NaN, Inf and overflow [fp64_lround, fp64_lrint] */
+static long fp64_tolong( float64_t x, uint8_t even )
+{
+	uint64_t a = x & ~FP64_SIGN;
+	int e = (int) (a >> 52) - 1023;
+	uint64_t m, frac, half;
+	uint32_t r;
+
+	if( a >= FP64_INF || e >= 31 )
+		return (int32_t) 0x80000000UL;
+	if( a == 0 || e < -1 )
+		return 0;
+	m = (a & 0x000fffffffffffffULL) | 0x0010000000000000ULL;
+	if( e == -1 ) {							// 0.5 <= |x| < 1
+		r = (!even || m != 0x0010000000000000ULL);
+	} else {
+		r = m >> (52 - e);
+		frac = m & ((1ULL << (52 - e)) - 1);
+		half = 1ULL << (51 - e);
+		if( frac > half || (frac == half && (!even || (r & 1))) )
+			r++;
+		if( !r )
+			return (int32_t) 0x80000000UL;	// carry due to rounding
+	}
+	if( x & FP64_SIGN )
+		r = -r;
+	return (int32_t) r;
+}
+
+long fp64_lround( float64_t x )
+{
+	return fp64_tolong( x, 0 );
+}
+
+long fp64_lrint( float64_t x )
+{
+	return fp64_tolong( x, 1 );
+}
+
+/* conversion to integer **************************************************/
+
+/* x converted to an integer of n bits (n odd: signed), rounded towards 0,
+   0 for NaN, Inf and overflow, no saturation [__fp64_fixxdfxi] */
+static uint64_t fp64_fixxdfxi( float64_t x, uint8_t n )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+	int16_t e;
+	uint8_t sh;
+	uint64_t v;
+
+	if( c != FP64_FINITE )
+		return 0;
+	e = a.e - 1023;
+	if( e >> 8 )
+		return 0;							// |x| < 1 or exponent > 255
+	sh = n - (uint8_t) e;
+	if( sh & 0x80 )
+		return 0;							// exponent > n
+	if( !(n & 1) )
+		sh--;
+	v = (sh < 64) ? (a.m << 8) >> sh : 0;
+	if( a.s ) {
+		if( n < 33 )
+			v &= 0xffffffff00000000ULL;
+		if( n < 17 )
+			v &= 0xffff000000000000ULL;
+		if( n < 9 )
+			v &= 0xff00000000000000ULL;
+		v = -v;
+	}
+	return v;
+}
+
+long long fp64_to_int64( float64_t A )
+{
+	return (int64_t) fp64_fixxdfxi( A, 63 );
+}
+
+long fp64_to_int32( float64_t A )
+{
+	return (int32_t) (fp64_fixxdfxi( A, 31 ) >> 32);
+}
+
+long fp64_float64_to_long( float64_t A )
+{
+	return fp64_to_int32( A );
+}
+
+int fp64_to_int16( float64_t A )
+{
+	return (int16_t) (fp64_fixxdfxi( A, 15 ) >> 48);
+}
+
+char fp64_to_int8( float64_t A )
+{
+	return (int8_t) (fp64_fixxdfxi( A, 7 ) >> 56);
+}
+
+unsigned long long fp64_to_uint64( float64_t A )
+{
+	return fp64_fixxdfxi( A, 64 );
+}
+
+unsigned long fp64_to_uint32( float64_t A )
+{
+	return (uint32_t) (fp64_fixxdfxi( A, 32 ) >> 32);
+}
+
+unsigned int fp64_to_uint16( float64_t A )
+{
+	return (uint16_t) (fp64_fixxdfxi( A, 16 ) >> 48);
+}
+
+unsigned char fp64_to_uint8( float64_t A )
+{
+	return (uint8_t) (fp64_fixxdfxi( A, 8 ) >> 56);
+}
+
+/* conversion from integer ************************************************/
+
+/* x with sign s, rounded to 53 bits [__fp64_di2sd] */
+static float64_t fp64_di2sd( uint64_t x, uint8_t s )
+{
+	fp64_split_t a;
+
+	if( !x )
+		return 0;
+	a.s = s;
+	a.e = 1023 + 55;
+	while( x > FP64_M56 ) {
+		x = (x >> 1) | (x & 1);				// keep shifted out bits as sticky bit
+		a.e++;
+	}
+	while( !(x & FP64_B55) ) {
+		x <<= 1;
+		a.e--;
+	}
+	a.m = x;
+	return __fp64_rpretA( &a );
+}
+
+float64_t fp64_int64_to_float64( long long x )
+{
+	return (x < 0) ? fp64_di2sd( -(uint64_t) x, 1 ) : fp64_di2sd( x, 0 );
+}
+
+float64_t fp64_uint64_to_float64( unsigned long long x )
+{
+	return fp64_di2sd( x, 0 );
+}
+
+float64_t fp64_int32_to_float64( long x )
+{
+	return fp64_int64_to_float64( (int32_t) x );
+}
+
+float64_t fp64_long_to_float64( long x )
+{
+	return fp64_int32_to_float64( x );
+}
+
+float64_t fp64_uint32_to_float64( unsigned long x )
+{
+	return fp64_di2sd( (uint32_t) x, 0 );
+}
+
+float64_t fp64_int16_to_float64( int16_t x )
+{
+	return fp64_int64_to_float64( x );
+}
+
+float64_t fp64_uint16_to_float64( uint16_t x )
+{
+	return fp64_di2sd( x, 0 );
+}
+
+/* conversion from and to float *******************************************/
+
+/* [fp64_sd] */
+float64_t fp64_sd( float x )
+{
+	uint32_t f;
+	uint8_t s, e;
+	fp64_split_t a;
+
+	memcpy( &f, &x, sizeof(f) );
+	s = f >> 31;
+	e = f >> 23;
+	f &= 0x007fffff;
+	if( e == 0xff )
+		return f ? FP64_NAN : __fp64_inf( s );
+	if( e == 0 && f == 0 )
+		return 0;							// -0.0f is returned as +0.0
+	a.s = s;
+	a.e = e + 1023 - 127;
+	if( e ) {
+		a.m = (uint64_t) (f | 0x00800000) << 32;
+	} else {
+		a.m = (uint64_t) f << 32;			// subnormal float is normalized
+		a.e++;
+		while( !(a.m & FP64_B55) ) {
+			a.m <<= 1;
+			a.e--;
+		}
+	}
+	return __fp64_pretA( &a );
+}
+
+/* [fp64_ds], the significand is truncated */
+float fp64_ds( float64_t x )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+	uint32_t r = (uint32_t) a.s << 31, m;
+	int16_t e;
+	float f;
+
+	if( c == FP64_ISNAN )
+		r = 0x7fc00000;
+	else if( c == FP64_INFINITE )
+		r |= 0x7f800000;
+	else if( c == FP64_FINITE ) {
+		e = a.e - 1023;
+		m = a.m >> 32;						// 24 bits
+		if( e >= 128 )
+			r |= 0x7f800000;
+		else if( e < -149 )
+			;								// underflow to +/-0
+		else if( e < -126 )
+			r |= m >> (-126 - e);
+		else
+			r |= ((uint32_t) (e + 127) << 23) | (m & 0x007fffff);
+	}
+	memcpy( &f, &r, sizeof(f) );
+	return f;
+}
@@ -0,0 +1,95 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64host.h
+   Internal declarations of the host build of fp64lib (libfp64host.a),
+   shared by fp64host.c and fp64host_str.c. The host build is a portable
+   C version of the assembler routines: it uses the same unpacked format
+   as __fp64_splitA, the same packing and rounding as __fp64_pretA and
+   __fp64_rpretA and follows the assembler code step by step wherever
+   the result depends on the order of operations, so that every result
+   is bit identical to the one of the AVR, including NaN payloads and
+   the output of the string conversions.
+   Only a subset of fp64lib is ported: arithmetic, comparison, rounding,
+   integer/float conversion and string output. Calls to the functions
+   listed as not available in fp64host.c fail at link time.
+*/
+
+#ifndef fp64host_h_included
+#define fp64host_h_included
+
+#ifndef FP64_HOST
+#define FP64_HOST
+#endif
+#include "../fp64lib.h"
+
+#define FP64_M56	0x00ffffffffffffffULL	// 56 bit significand of the unpacked format
+#define FP64_B55	0x0080000000000000ULL	// leading 1 bit of a normalized significand
+#define FP64_NAN	0x7ff8000000000000ULL	// the one NaN returned by all functions
+#define FP64_INF	0x7ff0000000000000ULL
+#define FP64_ONE	0x3ff0000000000000ULL
+#define FP64_SIGN	0x8000000000000000ULL
+
+/* classification as returned by __fp64_splitA in C and Z */
+#define FP64_FINITE	0
+#define FP64_ZERO	1
+#define FP64_INFINITE	2
+#define FP64_ISNAN	3
+
+/* unpacked number, see __fp64_splitA:
+	m	significand, 56 bits, leading 1 in bit 55 for normal numbers,
+		0x0..1 ... 0x7f..ff for subnormal numbers (with e = 1),
+		0 for zero and Inf, != 0 for NaN
+	e	exponent, base 1023, 0 for zero, 0x7ff for Inf/NaN;
+		16 bit arithmetic as in rAE1.rAE0
+	s	sign, 0 or 1 */
+typedef struct {
+	uint64_t m;
+	uint16_t e;
+	uint8_t s;
+} fp64_split_t;
+
+/* 128 bit unsigned integer for the exact intermediate results */
+typedef struct {
+	uint64_t hi, lo;
+} fp64_u128_t;
+
+uint8_t __fp64_splitA( fp64_split_t *a, float64_t x );
+float64_t __fp64_pretA( const fp64_split_t *a );
+float64_t __fp64_rpretA( const fp64_split_t *a );
+float64_t __fp64_inf( uint8_t s );
+float64_t __fp64_szero( uint8_t s );
+
+fp64_u128_t __fp64_mul128( uint64_t a, uint64_t b );
+fp64_u128_t __fp64_shl128( fp64_u128_t a, uint8_t n );
+fp64_u128_t __fp64_shr128( fp64_u128_t a, uint8_t n );
+uint8_t __fp64_clz128( fp64_u128_t a );
+
+#endif
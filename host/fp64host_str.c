@@ -0,0 +1,1013 @@
+/* Copyright (c) 2019-2020  Uwe Bissinger
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   * Redistributions of source code must retain the above copyright
+     notice, this list of conditions and the following disclaimer.
+   * Redistributions in binary form must reproduce the above copyright
+     notice, this list of conditions and the following disclaimer in
+     the documentation and/or other materials provided with the
+     distribution.
+   * Neither the name of the copyright holders nor the names of
+     contributors may be used to endorse or promote products derived
+     from this software without specific prior written permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+   POSSIBILITY OF SUCH DAMAGE. */
+
+/* $Id$ */
+
+/* fp64host_str.c
+   Host build of the conversions to string: fp64_to_decimalExp,
+   fp64_to_string, fp64_etoa, their reentrant variants and
+   fp64_to_string_sink. The digits are generated with the same truncated
+   64 bit multiplication as __fp64_mul64AB, the same powers of ten as
+   __fp64_10pown and __fp64_cachedpow and the same estimate of the decimal
+   exponent as __fp64_getExp10r, and the strings are edited in place in
+   the same order as by the assembler routines. So every result string,
+   including the quirks for small buffers, and every exponent returned
+   via exp10 is identical to the one on the AVR.
+*/
+
+#include <string.h>
+#include "fp64host.h"
+
+#define FP64_MARGIN	4		// units the rounding interval is widened, see __fp64_shortest
+#define FP64_BIGLEN	143		// max. bytes of a big integer, see __fp64_dragon4
+
+/* flags of fp64_to_string */
+#define fBelow1		0x01	// |x| < 1, "s0.mmmmmm"
+#define fAbove1		0x02	// log10(|x|) < max_chars, "smmm.mmm"
+#define fZero		0x40	// x == 0.0
+#define fSign		0x80	// x < 0
+
+static char __fp64_ftoabuf[FP64_BUFSIZE];
+
+/* helper functions *******************************************************/
+
+/* top 64 bits of a * b, partial products below 2^56 are ignored and
+   the result is rounded with bit 63 [__fp64_mul64AB] */
+static uint64_t fp64_mul64AB( uint64_t a, uint64_t b )
+{
+	fp64_u128_t s = { 0, 0 }, t;
+	uint16_t p;
+	uint8_t i, j;
+
+	for( i = 0; i < 8; i++ ) {
+		for( j = (i < 6) ? 6 - i : 0; j < 8; j++ ) {
+			p = (uint16_t) (uint8_t) (a >> (8*i)) * (uint8_t) (b >> (8*j));
+			t.hi = 0;
+			t.lo = p;
+			if( i + j == 6 )
+				t.lo = (uint64_t) (p >> 8) << 56;	// only the high byte
+			else
+				t = __fp64_shl128( t, 8*(i + j) );
+			s.lo += t.lo;
+			s.hi += t.hi + (s.lo < t.lo);
+		}
+	}
+	return s.hi + (s.lo >> 63);
+}
+
+/* shift c left until bit 63 is set, return number of shifts,
+   64 for c == 0 [__fp64_lshift64] */
+static uint8_t fp64_lshift64( uint64_t *c )
+{
+	uint8_t n = 0;
+
+	if( !*c )
+		return 64;
+	while( !(*c & FP64_SIGN) ) {
+		*c <<= 1;
+		n++;
+	}
+	return n;
+}
+
+/* log10(2^e), rounded up, with the approximation e * 0.301 and the
+   list of exponents where it fails [__fp64_getExp10r] */
+static int16_t fp64_getExp10r( int16_t e )
+{
+	static const uint16_t exc[] = {
+		196, 299, 392, 495, 588, 598, 681, 691, 784,
+		794, 877, 887, 897, 980, 990, 1000, 0x7fff
+	};
+	uint16_t u = (e < 0) ? -e : e;
+	int16_t r = ((uint32_t) u * 301 + 999) / 1000;
+	uint8_t i;
+
+	for( i = 0; u >= exc[i]; i++ ) {
+		if( u == exc[i] ) {
+			r++;
+			break;
+		}
+	}
+	return (e < 0) ? -r : r;
+}
+
+/* 64 bit significand of 10^n, 10^n = result * 2^(*exp2 - 63) [__fp64_10pown] */
+static uint64_t fp64_10pown( int16_t n, int16_t *exp2 )
+{
+	uint64_t res = FP64_SIGN, pot = 0xa000000000000000ULL;	// 1.0, 10.0
+	uint16_t u = n;
+	int16_t e = 0, pe = 3;
+	uint8_t neg = n < 0, sh;
+
+	if( neg ) {
+		u = -u;
+		pot = 0xcccccccccccccccdULL;		// 0.1
+	}
+	while( u ) {
+		if( u & 1 ) {
+			res = fp64_mul64AB( res, pot );
+			sh = fp64_lshift64( &res );
+			e += pe;
+			e += neg ? sh : 1 - sh;
+		}
+		pot = fp64_mul64AB( pot, pot );
+		sh = fp64_lshift64( &pot );
+		pe <<= 1;
+		pe += neg ? sh : 1 - sh;
+		u >>= 1;
+	}
+	*exp2 = neg ? -e : e;
+	return res;
+}
+
+/* cached power of ten 10^k with k = FP64_CACHED_KMIN + 8*i,
+   10^k = result * 2^(*exp2) [__fp64_cachedpow] */
+static uint64_t fp64_cachedpow( uint8_t i, int16_t *exp2 )
+{
+	static const struct {
+		uint64_t m;
+		int16_t e;
+	} cached[] = {
+	{ 0xfa8fd5a0081c0288ULL, -1220 },	// 10^-348, 2^-1220
+	{ 0xbaaee17fa23ebf76ULL, -1193 },	// 10^-340, 2^-1193
+	{ 0x8b16fb203055ac76ULL, -1166 },	// 10^-332, 2^-1166
+	{ 0xcf42894a5dce35eaULL, -1140 },	// 10^-324, 2^-1140
+	{ 0x9a6bb0aa55653b2dULL, -1113 },	// 10^-316, 2^-1113
+	{ 0xe61acf033d1a45dfULL, -1087 },	// 10^-308, 2^-1087
+	{ 0xab70fe17c79ac6caULL, -1060 },	// 10^-300, 2^-1060
+	{ 0xff77b1fcbebcdc4fULL, -1034 },	// 10^-292, 2^-1034
+	{ 0xbe5691ef416bd60cULL, -1007 },	// 10^-284, 2^-1007
+	{ 0x8dd01fad907ffc3cULL,  -980 },	// 10^-276, 2^-980
+	{ 0xd3515c2831559a83ULL,  -954 },	// 10^-268, 2^-954
+	{ 0x9d71ac8fada6c9b5ULL,  -927 },	// 10^-260, 2^-927
+	{ 0xea9c227723ee8bcbULL,  -901 },	// 10^-252, 2^-901
+	{ 0xaecc49914078536dULL,  -874 },	// 10^-244, 2^-874
+	{ 0x823c12795db6ce57ULL,  -847 },	// 10^-236, 2^-847
+	{ 0xc21094364dfb5637ULL,  -821 },	// 10^-228, 2^-821
+	{ 0x9096ea6f3848984fULL,  -794 },	// 10^-220, 2^-794
+	{ 0xd77485cb25823ac7ULL,  -768 },	// 10^-212, 2^-768
+	{ 0xa086cfcd97bf97f4ULL,  -741 },	// 10^-204, 2^-741
+	{ 0xef340a98172aace5ULL,  -715 },	// 10^-196, 2^-715
+	{ 0xb23867fb2a35b28eULL,  -688 },	// 10^-188, 2^-688
+	{ 0x84c8d4dfd2c63f3bULL,  -661 },	// 10^-180, 2^-661
+	{ 0xc5dd44271ad3cdbaULL,  -635 },	// 10^-172, 2^-635
+	{ 0x936b9fcebb25c996ULL,  -608 },	// 10^-164, 2^-608
+	{ 0xdbac6c247d62a584ULL,  -582 },	// 10^-156, 2^-582
+	{ 0xa3ab66580d5fdaf6ULL,  -555 },	// 10^-148, 2^-555
+	{ 0xf3e2f893dec3f126ULL,  -529 },	// 10^-140, 2^-529
+	{ 0xb5b5ada8aaff80b8ULL,  -502 },	// 10^-132, 2^-502
+	{ 0x87625f056c7c4a8bULL,  -475 },	// 10^-124, 2^-475
+	{ 0xc9bcff6034c13053ULL,  -449 },	// 10^-116, 2^-449
+	{ 0x964e858c91ba2655ULL,  -422 },	// 10^-108, 2^-422
+	{ 0xdff9772470297ebdULL,  -396 },	// 10^-100, 2^-396
+	{ 0xa6dfbd9fb8e5b88fULL,  -369 },	// 10^-92, 2^-369
+	{ 0xf8a95fcf88747d94ULL,  -343 },	// 10^-84, 2^-343
+	{ 0xb94470938fa89bcfULL,  -316 },	// 10^-76, 2^-316
+	{ 0x8a08f0f8bf0f156bULL,  -289 },	// 10^-68, 2^-289
+	{ 0xcdb02555653131b6ULL,  -263 },	// 10^-60, 2^-263
+	{ 0x993fe2c6d07b7facULL,  -236 },	// 10^-52, 2^-236
+	{ 0xe45c10c42a2b3b06ULL,  -210 },	// 10^-44, 2^-210
+	{ 0xaa242499697392d3ULL,  -183 },	// 10^-36, 2^-183
+	{ 0xfd87b5f28300ca0eULL,  -157 },	// 10^-28, 2^-157
+	{ 0xbce5086492111aebULL,  -130 },	// 10^-20, 2^-130
+	{ 0x8cbccc096f5088ccULL,  -103 },	// 10^-12, 2^-103
+	{ 0xd1b71758e219652cULL,   -77 },	// 10^-4, 2^-77
+	{ 0x9c40000000000000ULL,   -50 },	// 10^4, 2^-50
+	{ 0xe8d4a51000000000ULL,   -24 },	// 10^12, 2^-24
+	{ 0xad78ebc5ac620000ULL,     3 },	// 10^20, 2^3
+	{ 0x813f3978f8940984ULL,    30 },	// 10^28, 2^30
+	{ 0xc097ce7bc90715b3ULL,    56 },	// 10^36, 2^56
+	{ 0x8f7e32ce7bea5c70ULL,    83 },	// 10^44, 2^83
+	{ 0xd5d238a4abe98068ULL,   109 },	// 10^52, 2^109
+	{ 0x9f4f2726179a2245ULL,   136 },	// 10^60, 2^136
+	{ 0xed63a231d4c4fb27ULL,   162 },	// 10^68, 2^162
+	{ 0xb0de65388cc8ada8ULL,   189 },	// 10^76, 2^189
+	{ 0x83c7088e1aab65dbULL,   216 },	// 10^84, 2^216
+	{ 0xc45d1df942711d9aULL,   242 },	// 10^92, 2^242
+	{ 0x924d692ca61be758ULL,   269 },	// 10^100, 2^269
+	{ 0xda01ee641a708deaULL,   295 },	// 10^108, 2^295
+	{ 0xa26da3999aef774aULL,   322 },	// 10^116, 2^322
+	{ 0xf209787bb47d6b85ULL,   348 },	// 10^124, 2^348
+	{ 0xb454e4a179dd1877ULL,   375 },	// 10^132, 2^375
+	{ 0x865b86925b9bc5c2ULL,   402 },	// 10^140, 2^402
+	{ 0xc83553c5c8965d3dULL,   428 },	// 10^148, 2^428
+	{ 0x952ab45cfa97a0b3ULL,   455 },	// 10^156, 2^455
+	{ 0xde469fbd99a05fe3ULL,   481 },	// 10^164, 2^481
+	{ 0xa59bc234db398c25ULL,   508 },	// 10^172, 2^508
+	{ 0xf6c69a72a3989f5cULL,   534 },	// 10^180, 2^534
+	{ 0xb7dcbf5354e9beceULL,   561 },	// 10^188, 2^561
+	{ 0x88fcf317f22241e2ULL,   588 },	// 10^196, 2^588
+	{ 0xcc20ce9bd35c78a5ULL,   614 },	// 10^204, 2^614
+	{ 0x98165af37b2153dfULL,   641 },	// 10^212, 2^641
+	{ 0xe2a0b5dc971f303aULL,   667 },	// 10^220, 2^667
+	{ 0xa8d9d1535ce3b396ULL,   694 },	// 10^228, 2^694
+	{ 0xfb9b7cd9a4a7443cULL,   720 },	// 10^236, 2^720
+	{ 0xbb764c4ca7a44410ULL,   747 },	// 10^244, 2^747
+	{ 0x8bab8eefb6409c1aULL,   774 },	// 10^252, 2^774
+	{ 0xd01fef10a657842cULL,   800 },	// 10^260, 2^800
+	{ 0x9b10a4e5e9913129ULL,   827 },	// 10^268, 2^827
+	{ 0xe7109bfba19c0c9dULL,   853 },	// 10^276, 2^853
+	{ 0xac2820d9623bf429ULL,   880 },	// 10^284, 2^880
+	{ 0x80444b5e7aa7cf85ULL,   907 },	// 10^292, 2^907
+	{ 0xbf21e44003acdd2dULL,   933 },	// 10^300, 2^933
+	{ 0x8e679c2f5e44ff8fULL,   960 },	// 10^308, 2^960
+	{ 0xd433179d9c8cb841ULL,   986 },	// 10^316, 2^986
+	};
+
+	*exp2 = cached[i].e;
+	return cached[i].m;
+}
+
+/* store v as decimal number and terminating '\0' at p [__itoa_ncheck] */
+static void fp64_itoa( int16_t v, char *p )
+{
+	char t[5];
+	uint16_t u = v;
+	uint8_t n = 0;
+
+	if( v < 0 ) {
+		*p++ = '-';
+		u = -u;
+	}
+	do {
+		t[n++] = '0' + u % 10;
+		u /= 10;
+	} while( u );
+	while( n )
+		*p++ = t[--n];
+	*p = '\0';
+}
+
+/* digit generation *******************************************************/
+
+/* x *= f for the n bytes of the big integer x [__fp64_dragon4] */
+static void fp64_bigmul( uint8_t *x, uint8_t n, uint8_t f )
+{
+	uint16_t c = 0;
+
+	while( n-- ) {
+		c += (uint16_t) *x * f;
+		*x++ = c;
+		c >>= 8;
+	}
+}
+
+/* compare the n bytes of the big integers x and y, -1, 0 or 1 [__fp64_dragon4] */
+static int8_t fp64_bigcmp( const uint8_t *x, const uint8_t *y, uint8_t n )
+{
+	while( n-- ) {
+		if( x[n] != y[n] )
+			return (x[n] < y[n]) ? -1 : 1;
+	}
+	return 0;
+}
+
+/* sign of r + (y << sh) - s for the n bytes of the big integers [__fp64_dragon4] */
+static int8_t fp64_bigsum( const uint8_t *r, const uint8_t *y, const uint8_t *s,
+	uint8_t n, uint8_t sh )
+{
+	int16_t c = 0;
+	uint8_t i, top = 0, nz = 0;
+
+	for( i = 0; i < n; i++ ) {
+		c += r[i] + (uint8_t) ((y[i] << sh) | top) - s[i];
+		top = sh ? y[i] >> 7 : 0;
+		nz |= (uint8_t) c;
+		c >>= 8;
+	}
+	if( c )
+		return (c < 0) ? -1 : 1;
+	return nz ? 1 : 0;
+}
+
+/* shortest digits of the finite number a != 0 that are converted back
+   to a, Burger and Dybvig's free-format algorithm with big integers,
+   est is an estimate of the exponent of the first digit, +-1,
+   returns pointer behind the last digit, *exp10 is the exponent of
+   the first digit [__fp64_dragon4] */
+static char *fp64_dragon4( const fp64_split_t *a, char *p, int16_t est, int16_t *exp10 )
+{
+	uint8_t big[3*FP64_BIGLEN];
+	uint8_t *r = big, *s, *mm;
+	uint8_t t = (a->m == FP64_B55 && a->e >= 2);	// lower boundary is closer
+	uint8_t incl = !(a->m & 8);			// boundaries belong to x, if even
+	int16_t g = a->e - 1077;			// x = (m >> 1) * 2^g
+	uint16_t sh = (g < 0) ? 0 : g;
+	uint8_t n = (((g < 0) ? -g : g) + 72) >> 3;
+	uint64_t m = a->m >> 1;
+	int16_t k = est + 1;
+	uint16_t j;
+	uint8_t q, i, started = 0;
+	int8_t c, lo, hi;
+
+	s = r + n;
+	mm = s + n;
+	memset( big, 0, 3*n );
+
+	// r = 2x, mm = 2 m-, s = 1, scaled by 2^-g for g < 0
+	for( i = 0; i < 8; i++ ) {
+		uint16_t v = (uint16_t) (uint8_t) (m >> (8*i)) << (sh & 7);
+		r[(sh >> 3) + i] |= v;
+		r[(sh >> 3) + i + 1] |= v >> 8;
+	}
+	j = (t ? 1 : 2) << (sh & 7);
+	mm[sh >> 3] = j;
+	mm[(sh >> 3) + 1] = j >> 8;
+	sh = (g < 0) ? -g : 0;
+	s[sh >> 3] = 1 << (sh & 7);
+
+	// r/s = x / 10^k
+	for( j = (k < 0) ? -k : k; j; j -= q ) {
+		q = (j >= 2) ? 2 : 1;
+		if( k < 0 ) {
+			fp64_bigmul( r, n, (q == 2) ? 100 : 10 );
+			fp64_bigmul( mm, n, (q == 2) ? 100 : 10 );
+		} else
+			fp64_bigmul( s, n, (q == 2) ? 100 : 10 );
+	}
+	while( fp64_bigsum( r, mm, s, n, t ) + incl > 0 ) {
+		fp64_bigmul( s, n, 10 );		// upper boundary >= 10^k
+		k++;
+	}
+
+	for( ;; ) {
+		fp64_bigmul( r, n, 10 );
+		fp64_bigmul( mm, n, 10 );
+		for( q = 0; fp64_bigcmp( r, s, n ) >= 0; q++ ) {
+			for( i = 0, c = 0; i < n; i++ ) {	// r -= s
+				uint16_t d = r[i] - s[i] - c;
+				r[i] = d;
+				c = d >> 15;
+			}
+		}
+		lo = fp64_bigcmp( r, mm, n ) < incl;		// r - m- below x
+		hi = fp64_bigsum( r, mm, s, n, t ) + incl > 0;	// r + m+ above x
+		if( !lo && !hi ) {
+			if( q || started ) {
+				*p++ = '0' + q;
+				started = 1;
+			} else
+				k--;					// skip leading zero
+			continue;
+		}
+		if( lo && hi ) {				// both within, take the closer one
+			c = fp64_bigsum( r, r, s, n, 0 );
+			if( c > 0 || (c == 0 && (q & 1)) )
+				q++;
+		} else if( hi )
+			q++;
+		*p++ = '0' + q;
+		break;
+	}
+	*exp10 = k - 1;
+	return p;
+}
+
+/* shortest digits of the finite number a != 0 that are converted back
+   to a, Grisu3 algorithm with fp64_dragon4 as fallback, returns pointer
+   behind the last digit, *exp10 is the exponent of the first digit
+   [__fp64_shortest] */
+static char *fp64_shortest( const fp64_split_t *a, char *p, int16_t *exp10 )
+{
+	static const uint32_t ten[] = {
+		1000000000, 100000000, 10000000, 1000000, 100000,
+		10000, 1000, 100, 10, 1
+	};
+	char *p0 = p;
+	uint8_t t = (a->m == FP64_B55 && a->e >= 2);	// lower boundary is closer
+	uint8_t i = (uint16_t) (((uint32_t) (uint16_t) (2210 - a->e) * 154) >> 8) >> 4;
+	int16_t x = 348 - 8*i;				// -k = -(FP64_CACHED_KMIN + 8*i)
+	int16_t ek;
+	uint64_t ck = fp64_cachedpow( i, &ek );
+	uint8_t sh = (uint8_t) ek + (uint8_t) a->e - (uint8_t) 958;
+	uint64_t w = fp64_mul64AB( (a->m + 4) << 8, ck );	// W = m+ * 10^k
+	uint16_t d = ck >> 53;				// rounding interval delta
+	uint64_t p2, dl, u, lo;
+	uint32_t p1 = 0, pw;
+	uint8_t n, k, digit, d8, hi, started = 0;
+	int8_t ra, rb, rc, rs;
+
+	d += 2*FP64_MARGIN;					// widen interval
+	w += FP64_MARGIN;
+
+	// p1 = integral part of W, p2 = fractional part of W * 2^64
+	p2 = w;
+	dl = d;
+	for( ; sh >= 8; sh -= 8 ) {
+		p1 = (p1 << 8) | (uint8_t) (p2 >> 56);
+		p2 <<= 8;
+		dl = (dl << 8) & 0x0000ffffffffffffULL;
+	}
+	for( ; sh; sh-- ) {
+		p1 = (p1 << 1) | (uint8_t) (p2 >> 63);
+		p2 <<= 1;
+		dl = (dl << 1) & 0x0000ffffffffffffULL;
+	}
+
+	// phase 1: digits of the integral part
+	d8 = 0;
+	if( p1 ) {
+		n = 10;
+		k = 0;
+		do {							// skip leading zeros
+			n--;
+			pw = ten[k++];
+		} while( p1 < pw );
+		x += n;
+		for( ;; ) {
+			*p++ = '0' + p1 / pw;
+			p1 %= pw;
+			if( !p1 && p2 < dl )
+				goto check;				// no rounding possible, as delta < 10^n
+			if( k == 10 )
+				break;
+			pw = ten[k++];
+		}
+		started = 1;
+	}
+
+	// phase 2: digits of the fractional part, delta has 72 bits d8.dl
+	for( ;; ) {
+		fp64_u128_t q = __fp64_mul128( p2, 10 );
+		fp64_u128_t r = __fp64_mul128( dl, 10 );
+
+		p2 = q.lo;
+		digit = q.hi;
+		dl = r.lo;
+		d8 = d8 * 10 + (uint8_t) r.hi;
+		if( !started ) {
+			x--;						// skip leading zeros
+			if( !digit )
+				continue;
+			started = 1;
+		}
+		*p++ = '0' + digit;
+		if( !d8 && dl <= p2 )
+			continue;
+		break;
+	}
+
+check:
+	// the digits are exact, if they are within the interval for every
+	// possible error u = delta / 256 and closest to x, i.e. with
+	// rest = W - digits:
+	// ra = (delta - rest) >> 64, max. number of steps within the interval
+	// rc = (delta - 4u - rest) >> 64, or 68u, if lower boundary is closer
+	// rs = (delta / 2 - u - rest - 2^63) >> 64, moving is closer to x
+	// rb = (delta / 2 + u - rest - 2^63 - 1) >> 64, or for any x +- u
+	u = (dl >> 8) | ((uint64_t) d8 << 56);
+	ra = d8 - (dl < p2);
+	lo = dl - p2;
+	hi = ra;
+	for( k = t ? 68 : 4; k; k-- ) {
+		hi -= (lo < u);
+		lo -= u;
+	}
+	rc = hi;
+	lo = (dl >> 1) | ((uint64_t) d8 << 63);
+	hi = (d8 >> 1) - (lo < p2);
+	lo -= p2;
+	hi -= (lo < 0x8000000000000000ULL) + (lo - 0x8000000000000000ULL < u);
+	lo -= 0x8000000000000000ULL + u;
+	rs = hi;
+	hi += (lo + u < lo);
+	lo += u;
+	hi += (lo + u < lo);
+	lo += u;
+	hi -= (lo < 1);
+	rb = hi;
+
+	// move last digit towards x as long as it stays within the interval
+	for( n = 0; ra && rs >= 0; n++ ) {
+		p[-1]--;						// digit--, rest += 2^64
+		ra--;
+		rs--;
+		rb--;
+		rc--;
+	}
+	if( (ra && rb >= 0) || rc < 0 || (!n && (p2 < u || p2 - u < u)) )
+		return fp64_dragon4( a, p0, x, exp10 );	// not sure, get exact digits
+	*exp10 = x;
+	return p;
+}
+
+/* limit number of digits to 1 ... MAX_SIGNIFICAND */
+static uint8_t fp64_limit( uint8_t prec )
+{
+	if( prec > MAX_SIGNIFICAND )
+		prec = MAX_SIGNIFICAND;
+	return prec ? prec : 1;
+}
+
+/* convert the unpacked number a of class c into buf as "sd.dddEeee",
+   with prec digits (0: shortest representation), the significand is
+   terminated with '\0' if expSep is set, returns pointer to the result,
+   i.e. behind a leading '+' [__fp64_ftoa_pse, __fp64_ftoa_nan] */
+static char *fp64_ftoa_pse( const fp64_split_t *a, uint8_t c, char *buf,
+	uint8_t prec, uint8_t expSep, int16_t *exp10 )
+{
+	const char *s;
+	char *p = buf, *q;
+	uint64_t m;
+	int16_t e2, e10, ep;
+	uint8_t d, n;
+
+	if( c == FP64_ISNAN || c == FP64_INFINITE ) {
+		s = "NaN";
+		if( c == FP64_INFINITE ) {
+			*p++ = a->s ? '-' : '+';
+			s = "INF";
+		}
+		while( (*p++ = *s++) )
+			;
+		*p = '\0';						// additional '\0' for the exponent string
+		return buf;
+	}
+	if( c == FP64_ZERO ) {
+		prec = fp64_limit( prec );
+		*p++ = '0';
+		*p++ = '.';
+		while( --prec )
+			*p++ = '0';
+		*p++ = 'E';
+		*p++ = '0';
+		*p = '\0';
+		if( exp10 )
+			*exp10 = 0;
+		return buf;
+	}
+
+	*p++ = a->s ? '-' : '+';
+	if( !prec ) {
+		p = fp64_shortest( a, buf + 2, &e10 );
+	} else {
+		prec = fp64_limit( prec );
+
+		// m = significand * 10^-exp10, 1 <= m * 2^(e2-63) < 10
+		e2 = a->e - 1023;
+		e10 = fp64_getExp10r( e2 );
+		m = fp64_10pown( -e10, &ep );
+		e2 += ep;
+		m = fp64_mul64AB( m, a->m << 8 );
+		e2 += 1 - fp64_lshift64( &m );
+		while( e2 < 0 ) {
+			m = fp64_mul64AB( m, 0xa000000000000000ULL );
+			e2 += 4 - fp64_lshift64( &m );
+			e10--;
+		}
+		for( ;; ) {						// scale down if first digit > 9
+			d = e2;
+			if( d < 3 || (d == 3 && (m >> 56) < 0xa0) )
+				break;
+			m = fp64_mul64AB( m, 0xccccccccccccccccULL );
+			e2 -= 3 + fp64_lshift64( &m );
+			e10++;
+		}
+
+		// generate prec+1 digits behind sign and room for '.'
+		p = buf + 2;
+		for( n = prec + 1; n; n-- ) {
+			d = 0;
+			if( e2 >= 0 ) {
+				do {
+					d = (d << 1) | (m >> 63);
+					m <<= 1;
+				} while( --e2 >= 0 );
+			}
+			*p++ = '0' + d;
+			m = fp64_mul64AB( m, 0xa000000000000000ULL );
+			e2 += 4 - fp64_lshift64( &m );
+		}
+
+		// round with the last digit
+		if( *--p >= '5' ) {
+			q = p;
+			n = prec;
+			do {
+				if( *--q != '9' ) {
+					++*q;
+					goto exp;
+				}
+				*q = '0';
+			} while( --n );
+			e10++;						// all digits were 9, e.g. 999999
+			*q++ = '1';
+			for( n = prec; n; n-- )
+				*q++ = '0';
+		}
+	}
+
+exp:
+	buf[1] = buf[2];					// put first digit before the '.'
+	buf[2] = '.';
+	if( expSep )
+		*p++ = '\0';
+	*p++ = 'E';
+	if( e10 > 0 )
+		*p++ = '+';
+	fp64_itoa( e10, p );
+	if( exp10 )
+		*exp10 = e10;
+	return ((uint8_t) buf[0] < '-') ? buf + 1 : buf;	// skip leading '+'
+}
+
+/* result buffer handling *************************************************/
+
+/* return buf if it is large enough, else the zeroed scratch area
+   [__fp64_strbuf_enter] */
+static char *fp64_strbuf_enter( char *buf, uint8_t size, char *scratch )
+{
+	if( size >= FP64_BUFSIZE )
+		return buf;
+	memset( scratch, 0, FP64_BUFSIZE );
+	return scratch;
+}
+
+/* check whether the first string of result r fits into buf of size chars,
+   else reduce *maxDigits and return 1 to convert again [__fp64_strbuf_fits] */
+static uint8_t fp64_strbuf_fits( const char *r, uint8_t size, uint8_t *maxDigits )
+{
+	uint8_t len = 0, digits = 0, n;
+
+	if( size >= FP64_BUFSIZE || !size )
+		return 0;						// buf is used directly or nothing fits
+	for( ; *r && *r != 'E'; r++, len++ )
+		if( *r >= '0' && *r <= '9' )
+			digits++;
+	len += strlen( r ) + 1;				// exponent and '\0'
+	if( len <= size )
+		return 0;
+	len -= size;						// chars too many
+	n = (*maxDigits > MAX_SIGNIFICAND) ? MAX_SIGNIFICAND : *maxDigits;
+	if( !n )
+		n = digits;						// shortest representation
+	if( n > len )
+		n -= len;						// drop as many digits as chars are too many
+	else if( *maxDigits == 1 )
+		return 0;						// even 1 digit is too long
+	else
+		n = 1;							// but keep at least 1 digit
+	*maxDigits = n;
+	return 1;
+}
+
+/* copy nstr strings of result r into buf of size chars, if r was formatted
+   in the scratch area, store "" for a string that does not fit
+   [__fp64_strbuf_leave] */
+static char *fp64_strbuf_leave( char *r, char *buf, uint8_t size, uint8_t nstr )
+{
+	char *p = buf;
+	uint8_t n;
+
+	if( size >= FP64_BUFSIZE )
+		return r;						// result is already in buf
+	if( !size )
+		return NULL;
+	do {
+		n = strlen( r ) + 1;
+		if( n > size ) {
+			if( size )
+				*p = '\0';				// no truncated number
+			break;
+		}
+		memcpy( p, r, n );
+		p += n;
+		r += n;
+		size -= n;
+	} while( --nstr );
+	return buf;
+}
+
+/* fp64_to_decimalExp *****************************************************/
+
+static char *fp64_ftoa( float64_t x, uint8_t maxDigits, uint8_t expSep,
+	int16_t *exp10, char *buf )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+
+	return fp64_ftoa_pse( &a, c, buf, maxDigits, expSep, exp10 );
+}
+
+char *fp64_to_decimalExp( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10 )
+{
+	return fp64_to_decimalExp_r( x, maxDigits, expSep, exp10, __fp64_ftoabuf, FP64_BUFSIZE );
+}
+
+char *fp64_to_decimalExp_r( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10, char *buf, uint8_t size )
+{
+	char scratch[FP64_BUFSIZE];
+	char *s = fp64_strbuf_enter( buf, size, scratch );
+	char *r;
+
+	do										// reduce maxDigits until the result fits
+		r = fp64_ftoa( x, maxDigits, expSep, exp10, s );
+	while( fp64_strbuf_fits( r, size, &maxDigits ) );
+	return fp64_strbuf_leave( r, buf, size, expSep ? 2 : 1 );
+}
+
+/* fp64_etoa **************************************************************/
+
+/* as fp64_ftoa, but with an exponent that is a multiple of 3 [fp64_etoa] */
+static char *fp64_etoa_pse( float64_t x, uint8_t maxDigits, uint8_t expSep,
+	int16_t *exp10, char *buf )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+	int16_t e10 = 0;
+	char *s = fp64_ftoa_pse( &a, c, buf, maxDigits, expSep, &e10 );
+	char *p = s;
+	uint16_t u;
+	uint8_t q, mod;
+	char ch;
+
+	if( c == FP64_ISNAN || c == FP64_INFINITE )
+		return s;						// exp10 is not stored for NaN/Inf
+	if( *s == '0' )
+		goto save;						// nothing to do for 0
+
+	// mod = exponent mod 3 for positive exponents, 3 - (-exponent mod 3) else,
+	// with x / 3 = x * 171 >> 9 for x < 512
+	u = (e10 < 0) ? -e10 : e10;
+	q = ((uint16_t) (uint8_t) ((u >> 8) * 171) + (((u & 0xff) * 171) >> 8)) >> 1;
+	mod = u - 3*q;
+	if( e10 < 0 && mod )
+		mod = 3 - mod;
+	if( !mod )
+		goto save;
+
+	// move the '.' by mod digits to the right
+	ch = *p++;
+	if( ch == '-' || ch == '+' )
+		ch = *p++;						// skip sign
+	ch = *p++;							// '.' or exponent delimiter
+	if( mod == 1 ) {
+		if( ch == 'E' || !ch ) {		// "aEeee" --> "a0Ee-1"
+			p--;
+			goto case1b;
+		}
+		ch = *p--;
+		if( ch == 'E' || !ch ) {		// "a.Eeee" --> "a0Ee-1"
+case1b:
+			*p++ = '0';
+			*p++ = ch;
+			goto decE;
+		}
+		*p++ = ch;						// "a.b" --> "ab."
+		*p++ = '.';
+		ch = *p++;
+		if( ch == 'E' || !ch ) {		// "a.bEeee" --> "abEe-1"
+			p--;
+			*p++ = ch;
+			goto decE;
+		}
+	} else {
+		if( ch == 'E' || !ch ) {		// "aEeee" --> "a00Ee-2"
+			p--;
+			goto case21b;
+		}
+		ch = *p--;
+		if( ch == 'E' || !ch ) {		// "a.Eeee" --> "a00Ee-2"
+case21b:
+			*p++ = '0';
+			goto case22;
+		}
+		*p++ = ch;						// "a.bc" --> "abbc"
+		ch = p[1];
+		if( ch == 'E' || !ch ) {		// "a.bEeee" --> "ab0Ee-2"
+case22:
+			*p++ = '0';
+			*p++ = ch;
+			goto decE;
+		}
+		*p++ = ch;						// "abbc" --> "abc."
+		*p++ = '.';
+		ch = *p++;
+		if( ch == 'E' || !ch ) {		// "a.bcEeee" --> "abcEe-2"
+			p--;
+			*p++ = ch;
+			goto decE;
+		}
+	}
+	do {								// scan for exponent delimiter
+		ch = *p++;
+	} while( ch != 'E' && ch );
+
+decE:
+	e10 -= mod;
+	if( e10 > 0 )
+		*p++ = '+';
+	fp64_itoa( e10, p );
+
+save:
+	if( exp10 )
+		*exp10 = e10;
+	return s;
+}
+
+char *fp64_etoa( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10 )
+{
+	return fp64_etoa_r( x, maxDigits, expSep, exp10, __fp64_ftoabuf, FP64_BUFSIZE );
+}
+
+char *fp64_etoa_r( float64_t x, uint8_t maxDigits, uint8_t expSep, int16_t *exp10, char *buf, uint8_t size )
+{
+	char scratch[FP64_BUFSIZE];
+	char *s = fp64_strbuf_enter( buf, size, scratch );
+	char *r;
+
+	do										// reduce maxDigits until the result fits
+		r = fp64_etoa_pse( x, maxDigits, expSep, exp10, s );
+	while( fp64_strbuf_fits( r, size, &maxDigits ) );
+	return fp64_strbuf_leave( r, buf, size, expSep ? 2 : 1 );
+}
+
+/* fp64_to_string *********************************************************/
+
+/* format x with at most nrd chars into buf [fp64_to_string] */
+static char *fp64_tostring( float64_t x, uint8_t nrd, uint8_t zeros, char *buf )
+{
+	fp64_split_t a;
+	uint8_t c = __fp64_splitA( &a, x );
+	uint8_t flags = 0, prec, n;
+	int16_t exp10 = 0, e;
+	uint16_t u;
+	char *s0, *s, *p, *q = NULL, *end, ch;
+
+	if( c == FP64_ISNAN || c == FP64_INFINITE )
+		return fp64_ftoa_pse( &a, c, buf, 0, 0, NULL );
+	if( c == FP64_ZERO )
+		flags |= fZero;
+	if( a.s ) {
+		flags |= fSign;
+		if( nrd )
+			nrd--;
+	}
+
+	// get exp10 of x
+	fp64_ftoa_pse( &a, c, buf, 1, 0, &exp10 );
+
+layout:
+	if( a.e < 0x3ff ) {					// |x| < 1 --> "s0.mmmmmm" without exponent
+		if( exp10 ) {
+			if( (uint8_t) (exp10 >> 8) != 0xff )
+				goto exp;
+			n = -(uint8_t) exp10;
+			if( !n || zeros < n )
+				goto exp;				// too many leading 0s
+		}
+		n = -(uint8_t) exp10;
+		if( nrd < n )
+			goto exp;
+		prec = nrd - n;
+		if( !exp10 ) {
+			if( !prec )
+				goto exp;
+			prec--;
+		}
+		if( prec <= 1 )
+			goto exp;					// not even one digit fits in
+		prec--;
+		flags |= fBelow1;
+		goto get;
+	}
+	if( (exp10 >> 8) || (uint8_t) exp10 >= nrd || (uint8_t) exp10 >= MAX_SIGNIFICAND )
+		goto exp;						// all digits before '.' have to be significant
+	flags |= fAbove1;					// "mmm.mmm" without exponent
+	prec = nrd - 1;						// -1 for "."
+	if( (uint8_t) exp10 == prec )
+		prec = nrd;						// no digit after '.', just "mmmm"
+	goto get;
+
+exp:									// "sm.mmmmmESnnn"
+	u = (exp10 < 0) ? -exp10 : exp10;
+	n = (u >= 100) ? 3 : ((u >= 10) ? 2 : 1);
+	prec = nrd - (n + 3);				// at least 1 digit, "E" and sign of exponent
+	if( prec & 0x80 )
+		prec = 0;
+
+get:
+	prec = fp64_limit( prec );
+	e = exp10;
+	s0 = s = fp64_ftoa_pse( &a, c, buf, prec, 0, &exp10 );
+	if( exp10 < e ) {					// exp10 was estimated with 1 digit, e.g. 9.96E-10 gives 1E-9,
+		flags &= ~(fBelow1 | fAbove1);	// so the result is one char longer than planned
+		goto layout;
+	}
+	if( flags & fZero ) {
+		s[1] = '\0';
+		return s0;
+	}
+	if( flags & fSign )
+		s++;
+
+	if( flags & fBelow1 ) {
+		if( !exp10 ) {					// 0.99999 got rounded to 1.0
+			flags = (flags & ~fBelow1) | fAbove1;
+			prec--;
+		} else {						// "0.mmmm", keep prec, exp10 may be higher than planned
+			s[1] = s[0];				// "m.mmm" --> "mmmm"
+			q = s + prec;
+			p = q - exp10;
+			end = p + 1;
+			while( (int8_t) --prec >= 0 )
+				*p-- = *q--;
+			for( n = ~(uint8_t) exp10; n; n-- )
+				*p-- = '0';
+			*p-- = '.';
+			*p = '0';
+			p = end;
+			goto cut;
+		}
+	}
+	if( flags & fAbove1 ) {				// "mmm.mmm", move the '.' to the right position
+		p = s + 1;
+		end = p + prec;
+		for( n = exp10; n; n-- ) {
+			*p = p[1];
+			p++;
+		}
+		if( (uint8_t) exp10 == --prec ) {
+			*p = '\0';					// digits after '.' do not fit in
+			return s0;
+		}
+		*p = '.';
+		p = end;
+		goto cut;
+	}
+	p = s + prec + 1;					// exponential form
+	q = p;
+
+cut:									// remove trailing 0s
+	while( *--p == '0' )
+		;
+	if( *p == '.' )
+		p--;
+	if( flags & (fAbove1 | fBelow1) ) {
+		*++p = '\0';
+	} else {
+		p++;
+		do {							// copy exponent part
+			ch = *q++;
+			*p++ = ch;
+		} while( ch );
+	}
+	return s0;
+}
+
+char *fp64_to_string( float64_t x, uint8_t max_nr_chars, uint8_t max_leading_mantisse_zeros )
+{
+	return fp64_to_string_r( x, max_nr_chars, max_leading_mantisse_zeros, __fp64_ftoabuf, FP64_BUFSIZE );
+}
+
+char *fp64_to_string_r( float64_t x, uint8_t max_nr_chars, uint8_t max_leading_mantisse_zeros, char *buf, uint8_t size )
+{
+	char scratch[FP64_BUFSIZE];
+
+	if( max_nr_chars >= size )
+		max_nr_chars = size ? size - 1 : 0;	// room for '\0'
+	if( max_nr_chars > FP64_BUFSIZE - 2 )
+		max_nr_chars = FP64_BUFSIZE - 2;	// and for the sign in the scratch area
+	return fp64_strbuf_leave(
+		fp64_tostring( x, max_nr_chars, max_leading_mantisse_zeros, fp64_strbuf_enter( buf, size, scratch ) ),
+		buf, size, 1 );
+}
+
+uint8_t fp64_to_string_sink( float64_t x, uint8_t max_nr_chars, uint8_t max_leading_mantisse_zeros, void (*sink)( char c, void *ctx ), void *ctx )
+{
+	char scratch[FP64_BUFSIZE];
+	char *s;
+	uint8_t n = 0;
+
+	if( max_nr_chars >= FP64_BUFSIZE - 1 )
+		max_nr_chars = FP64_BUFSIZE - 2;
+	s = fp64_tostring( x, max_nr_chars, max_leading_mantisse_zeros, fp64_strbuf_enter( NULL, 0, scratch ) );
+	for( ; *s; s++, n++ )
+		sink( *s, ctx );
+	return n;
+}